@@ -0,0 +1,51 @@
+#include "AudioLoopback.h"
+#include <stdio.h>
+
+using namespace std;
+
+bool AudioLoopback::open(int sampleRate) {
+  close();
+  if (!alcIsExtensionPresent(NULL, "ALC_SOFT_loopback")) {
+    fprintf(stderr, "OpenAL has no loopback device (ALC_SOFT_loopback), OpenAL Soft has\n");
+    return false;
+  }
+  LPALCLOOPBACKOPENDEVICESOFT openDevice =
+      (LPALCLOOPBACKOPENDEVICESOFT)alcGetProcAddress(NULL, "alcLoopbackOpenDeviceSOFT");
+  LPALCISRENDERFORMATSUPPORTEDSOFT formatSupported =
+      (LPALCISRENDERFORMATSUPPORTEDSOFT)alcGetProcAddress(NULL, "alcIsRenderFormatSupportedSOFT");
+  renderSamples = (LPALCRENDERSAMPLESSOFT)alcGetProcAddress(NULL, "alcRenderSamplesSOFT");
+  if (!openDevice || !formatSupported || !renderSamples || !(device = openDevice(NULL))) {
+    fprintf(stderr, "could not open the OpenAL loopback device\n");
+    return false;
+  }
+  if (!formatSupported(device, sampleRate, ALC_STEREO_SOFT, ALC_SHORT_SOFT)) {
+    fprintf(stderr, "the OpenAL loopback device can't render 16-bit stereo at %d Hz\n", sampleRate);
+    close();
+    return false;
+  }
+  const ALCint attributes[] = {
+    ALC_FORMAT_CHANNELS_SOFT, ALC_STEREO_SOFT,
+    ALC_FORMAT_TYPE_SOFT, ALC_SHORT_SOFT,
+    ALC_FREQUENCY, sampleRate,
+    0
+  };
+  context = alcCreateContext(device, attributes);
+  if (!context || !alcMakeContextCurrent(context)) {
+    fprintf(stderr, "could not make an OpenAL context on the loopback device\n");
+    close();
+    return false;
+  }
+  rate = sampleRate;
+  return true;
+}
+
+void AudioLoopback::close() {
+  if (context) {
+    if (alcGetCurrentContext() == context) alcMakeContextCurrent(NULL);
+    alcDestroyContext(context);
+  }
+  if (device) alcCloseDevice(device);
+  context = NULL;
+  device = NULL;
+  rate = 0;
+}
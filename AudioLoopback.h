@@ -0,0 +1,50 @@
+#ifndef AUDIO_LOOPBACK_H
+#define AUDIO_LOOPBACK_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <AL/al.h>
+#include <AL/alc.h>
+#include <AL/alext.h>
+
+// An OpenAL context on OpenAL Soft's loopback device (ALC_SOFT_loopback):
+// nothing plays, the mix is rendered into memory when render() asks for it,
+// as fast as the CPU allows and at a fixed rate and format. Needs no sound
+// hardware, so audio can be rendered, measured and compared on a headless
+// machine.
+//
+// Rendering is driven by the caller, so the threads that normally keep
+// OpenAL fed are not wanted here: start MusicStream and SoundEngine with
+// their background flag false and call pump() / update() between renders.
+//
+//   AudioLoopback out;
+//   if (!out.open(44100)) ...              // the context is now current
+//   sounds.start(false);
+//   sounds.play(...);
+//   sounds.update();
+//   out.render(samples, 1024);             // 1024 stereo frames
+class AudioLoopback {
+  public:
+    AudioLoopback() : device(NULL), context(NULL), renderSamples(NULL), rate(0) {}
+    ~AudioLoopback() { close(); }
+
+    // 16-bit stereo at 'sampleRate', made the current context; false with
+    // a message if the OpenAL library has no loopback device
+    bool open(int sampleRate);
+    void close();
+
+    int sampleRate() const { return rate; }
+    // the next 'frames' frames of the mix, interleaved left and right
+    void render(int16_t* out, int frames) { renderSamples(device, out, frames); }
+
+  private:
+    ALCdevice* device;
+    ALCcontext* context;
+    LPALCRENDERSAMPLESSOFT renderSamples;
+    int rate;
+
+    AudioLoopback(const AudioLoopback&);
+    AudioLoopback& operator=(const AudioLoopback&);
+};
+
+#endif
@@ -0,0 +1,160 @@
+#ifndef BLOCK_MAZE_H
+#define BLOCK_MAZE_H
+
+#include <assert.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include <vector>
+
+// The block map the game draws and collides against: one byte per block,
+// WALL or GROUND, indexed maze[x][z] like the int maze[][] array it replaces.
+//
+// The algorithms are written once in BlockMaze and the storage is a policy:
+//   FixedMaze<W, H>  size known at compile time; the array, the row stride and
+//                    every loop bound are constants, so small mazes get fully
+//                    unrolled or vectorized loops and no heap
+//   DynamicMaze      size chosen at runtime, same interface
+//
+//   FixedMaze<13, 13> maze;        DynamicMaze big(1001, 1001);
+//   maze[x][z] = maze.GROUND;
+//
+// Blocks are stored x-major (z varies fastest), the stride from x to x + 1 is
+// height(). Sides are limited to 65535 blocks.
+
+template <int W, int H> class FixedBlocks {
+  public:
+    explicit FixedBlocks(int w = W, int h = H) { assert(w == W && h == H); (void)w; (void)h; }
+
+    static constexpr int width() { return W; }
+    static constexpr int height() { return H; }
+    static constexpr size_t size() { return (size_t)W * H; }
+    unsigned char* data() { return blocks; }
+    const unsigned char* data() const { return blocks; }
+
+    // per block scratch space for the algorithms, on the stack
+    template <class T> struct Buffer {
+      T v[W * H];
+      explicit Buffer(size_t) {}
+      T& operator[](size_t i) { return v[i]; }
+    };
+
+  private:
+    unsigned char blocks[W * H];
+};
+
+class DynamicBlocks {
+  public:
+    DynamicBlocks(int width, int height) : w(width), h(height), blocks((size_t)width * height) {}
+
+    int width() const { return w; }
+    int height() const { return h; }
+    size_t size() const { return blocks.size(); }
+    unsigned char* data() { return blocks.data(); }
+    const unsigned char* data() const { return blocks.data(); }
+
+    template <class T> struct Buffer : std::vector<T> {
+      explicit Buffer(size_t n) : std::vector<T>(n) {}
+    };
+
+  private:
+    int w, h;
+    std::vector<unsigned char> blocks;
+};
+
+template <class Storage> class BlockMaze : public Storage {
+  public:
+    enum { WALL = 0, GROUND = 2 };  // the values maze[][] always held
+
+    BlockMaze() {}
+    BlockMaze(int width, int height) : Storage(width, height) {}
+
+    unsigned char* operator[](int x) { return this->data() + (size_t)x * this->height(); }
+    const unsigned char* operator[](int x) const { return this->data() + (size_t)x * this->height(); }
+
+    bool wall(int x, int z) const { return (*this)[x][z] == WALL; }
+    // anything outside the map is a wall
+    bool wallAt(int x, int z) const {
+      return x < 0 || z < 0 || x >= this->width() || z >= this->height() || wall(x, z);
+    }
+
+    void fill(unsigned char value) { memset(this->data(), value, this->size()); }
+
+    size_t groundCount() const {
+      const unsigned char* b = this->data();
+      size_t n = 0;
+      for (size_t i = 0; i < this->size(); i++) n += b[i] != WALL;
+      return n;
+    }
+
+    // wall faces that border ground, the quads a mesh of the maze needs.
+    // Blocks only ever hold WALL or GROUND, so a face is two different bytes
+    size_t exposedFaces() const {
+      const unsigned char* b = this->data();
+      const size_t n = this->size(), h = this->height();
+      // neighbours along x are h apart: one flat run over the whole map;
+      // neighbours along z are next to each other: one flat run too, minus
+      // the pairs that straddle the end of one column and the next
+      size_t faces = differing(b, b + h, n - h) + differing(b, b + 1, n - 1);
+      for (size_t i = h; i < n; i += h) faces -= b[i - 1] != b[i];
+      return faces;
+    }
+
+    // walking distance in blocks from (sx, sz) to every block, -1 for walls and
+    // blocks that can't be reached; 'out' holds size() ints. Returns the largest.
+    // Distances are ints, fine as long as no path is 2^31 blocks long
+    int distances(int sx, int sz, int* out) const {
+      const unsigned char* b = this->data();
+      const int h = this->height(), w = this->width();
+      for (size_t i = 0; i < this->size(); i++) out[i] = -1;
+      if (wallAt(sx, sz)) return -1;
+
+      // the queue holds x << 16 | z, so no division is needed to get back to x and z
+      typename Storage::template Buffer<unsigned> queue(this->size());
+      size_t head = 0, tail = 0;
+      int far = 0;
+      queue[tail++] = sx << 16 | sz;
+      out[(size_t)sx * h + sz] = 0;
+      while (head < tail) {
+        unsigned q = queue[head++];
+        int x = q >> 16, z = q & 0xffff;
+        size_t i = (size_t)x * h + z;
+        far = out[i];
+        if (x + 1 < w && b[i + h] != WALL && out[i + h] < 0) { out[i + h] = far + 1; queue[tail++] = q + 0x10000; }
+        if (x > 0 && b[i - h] != WALL && out[i - h] < 0) { out[i - h] = far + 1; queue[tail++] = q - 0x10000; }
+        if (z + 1 < h && b[i + 1] != WALL && out[i + 1] < 0) { out[i + 1] = far + 1; queue[tail++] = q + 1; }
+        if (z > 0 && b[i - 1] != WALL && out[i - 1] < 0) { out[i - 1] = far + 1; queue[tail++] = q - 1; }
+      }
+      return far;
+    }
+
+  private:
+    // bytes that differ between p[0, len) and q[0, len), eight at a time:
+    // WALL ^ GROUND is 2, so a differing byte leaves just bit 1, which lands
+    // in bit 0 of the same byte when shifted. The bytes of 'lanes' count
+    // them, emptied before any reaches 255. With FixedBlocks 'len' is a
+    // constant and the loop unrolls whole
+    static size_t differing(const unsigned char* p, const unsigned char* q, size_t len) {
+      const uint64_t ones = 0x0101010101010101ULL;
+      size_t count = 0, i = 0;
+      while (i + 8 <= len) {
+        uint64_t lanes = 0;
+        for (int k = 0; k < 255 && i + 8 <= len; k++, i += 8) {
+          uint64_t a, b;
+          memcpy(&a, p + i, 8);
+          memcpy(&b, q + i, 8);
+          lanes += (a ^ b) >> 1 & ones;
+        }
+        // the sum of the eight byte lanes lands in the top byte, up to 8 * 255
+        count += (lanes & 0x00ff00ff00ff00ffULL) * 0x0001000100010001ULL >> 48;
+        count += (lanes >> 8 & 0x00ff00ff00ff00ffULL) * 0x0001000100010001ULL >> 48;
+      }
+      for (; i < len; i++) count += p[i] != q[i];
+      return count;
+    }
+};
+
+template <int W, int H> using FixedMaze = BlockMaze<FixedBlocks<W, H> >;
+typedef BlockMaze<DynamicBlocks> DynamicMaze;
+
+#endif
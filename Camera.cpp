@@ -1,4 +1,5 @@
 #include <iostream>
+#include <glm/gtc/matrix_transform.hpp>
 #include "Camera.h"
 
 using namespace std;
@@ -7,6 +8,9 @@ Camera::Camera(vec3 pos, vec3 dirn) {
   // constructor, specify the intial camera_coordinates, look_at vector, extremes of frustum, and near-far Z planes
   camera_coordinates = pos;
   look_at = dirn;
+  aspect = 1.0;
+  changes = 0;
+  dirty = 0;
   updateFrustum();
 }
 
@@ -18,9 +22,38 @@ void Camera::updateFrustum(){
   lrbt.w = camera_coordinates.y+50.0;  // top
   zplanes.x = 5.0;  // near distance (+ve) from the camera
   zplanes.y = 50.0; // far distance (+ve) from the camera
+  dirty |= VIEW_DIRTY | PROJECTION_DIRTY;
+  changes++;
 }
 
-vec3 Camera::getCameraCoordinates() {
+void Camera::update() const {
+  if (dirty & VIEW_DIRTY) {
+    view = mat4(glm::lookAt(camera_coordinates, look_at, vec3(0.0, 1.0, 0.0)));
+  }
+  if (dirty & PROJECTION_DIRTY) {
+    // the same matrix glFrustum builds, widened about its centre for the viewport
+    float centre = (lrbt.x + lrbt.y) * 0.5f, half = (lrbt.y - lrbt.x) * 0.5f * aspect;
+    projection = mat4(glm::frustum(centre - half, centre + half, lrbt.z, lrbt.w, zplanes.x, zplanes.y));
+  }
+  view_projection = projection * view;
+
+  // each plane is the last row of the view-projection matrix plus or minus
+  // another row (Gribb & Hartmann); transposed, the rows are columns
+  mat4 rows = glm::transpose(view_projection);
+  planes[PLANE_LEFT] = rows[3] + rows[0];
+  planes[PLANE_RIGHT] = rows[3] - rows[0];
+  planes[PLANE_BOTTOM] = rows[3] + rows[1];
+  planes[PLANE_TOP] = rows[3] - rows[1];
+  planes[PLANE_NEAR] = rows[3] + rows[2];
+  planes[PLANE_FAR] = rows[3] - rows[2];
+  for (int i = 0; i < PLANES; i++) {
+    plane& p = planes[i];
+    p /= sqrt(p.x * p.x + p.y * p.y + p.z * p.z);
+  }
+  dirty = 0;
+}
+
+vec3 Camera::getCameraCoordinates() const {
   return camera_coordinates;
 }
 
@@ -30,18 +63,45 @@ void Camera::updateCameraCoordinates(vec3 pos) {
   updateFrustum();
 }
 
-vec3 Camera::getLookAtVector() {
+vec3 Camera::getLookAtVector() const {
   return look_at;
 }
 
 void Camera::updateLookAtVector(vec3 dirn) {
   look_at = dirn;
+  dirty |= VIEW_DIRTY;
+  changes++;
+}
+
+void Camera::updateViewport(int width, int height) {
+  float a = height > 0 ? (float)width / height : 1.0;
+  if (a == aspect) return;
+  aspect = a;
+  dirty |= PROJECTION_DIRTY;
+  changes++;
 }
 
-vec4 Camera::getlrbt() {
+const vec4& Camera::getlrbt() const {
   return lrbt;
 }
 
-vec2 Camera::getZplanes() {
+const vec2& Camera::getZplanes() const {
   return zplanes;
 }
+
+bool Camera::sphereVisible(vec3 centre, float radius) const {
+  const plane* p = getFrustumPlanes();
+  for (int i = 0; i < PLANES; i++)
+    if (p[i].x * centre.x + p[i].y * centre.y + p[i].z * centre.z + p[i].w < -radius) return false;
+  return true;
+}
+
+bool Camera::boxVisible(vec3 low, vec3 high) const {
+  const plane* p = getFrustumPlanes();
+  for (int i = 0; i < PLANES; i++) {
+    // the corner furthest along the plane normal
+    float x = p[i].x > 0 ? high.x : low.x, y = p[i].y > 0 ? high.y : low.y, z = p[i].z > 0 ? high.z : low.z;
+    if (p[i].x * x + p[i].y * y + p[i].z * z + p[i].w < 0) return false;
+  }
+  return true;
+}
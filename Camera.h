@@ -1,25 +1,71 @@
+#ifndef CAMERA_H
+#define CAMERA_H
+
 #include <iostream>
 #include <vector>
 #include <glm/glm.hpp>
+#include <glm/gtc/type_aligned.hpp>
 
 using glm::vec4;
 using glm::vec3;
 using glm::vec2;
 using std::vector;
 
+// The camera position and look-at point, and the matrices and frustum planes
+// they give. The view, projection and view-projection matrices and the six
+// frustum planes are kept in 16-byte aligned glm types, so glm computes them
+// with its SSE code, and only recomputed the first time they are asked for
+// after the camera or the viewport changed: a frame that doesn't move the
+// camera builds nothing. The matrices are column major, as glUniformMatrix4fv
+// and glLoadMatrixf take them:
+//
+//   glUniformMatrix4fv(uniform_v, 1, GL_FALSE, glm::value_ptr(camera.getView()));
+//   if (camera.sphereVisible(centre, radius)) draw(...);
 class Camera {
 
+  public:
+    typedef glm::mat<4, 4, float, glm::aligned_highp> mat4;
+    typedef glm::vec<4, float, glm::aligned_highp> plane;  // inside where dot(xyz, p) + w >= 0
+
+    enum { PLANE_LEFT, PLANE_RIGHT, PLANE_BOTTOM, PLANE_TOP, PLANE_NEAR, PLANE_FAR, PLANES };
+
   private:
+    enum { VIEW_DIRTY = 1, PROJECTION_DIRTY = 2 };
+
     vec3 camera_coordinates, look_at;
     vec4 lrbt;  // (x,y,z,w) = (left, right, bottom, top)
     vec2 zplanes; // (x,y) = (near, far) Z plane distance from the camera
+    float aspect; // viewport width / height, widens the frustum from left to right
+    unsigned changes; // bumped on every change, see getVersion()
+
+    mutable unsigned dirty;
+    mutable mat4 view, projection, view_projection;
+    mutable plane planes[PLANES];
+
     void updateFrustum();
+    void update() const;
   public:
     Camera(vec3, vec3);
-  	vec3 getCameraCoordinates();
-    vec3 getLookAtVector();
-    vec4 getlrbt();
-    vec2 getZplanes();
+  	vec3 getCameraCoordinates() const;
+    vec3 getLookAtVector() const;
+    const vec4& getlrbt() const;
+    const vec2& getZplanes() const;
     void updateCameraCoordinates(vec3);
     void updateLookAtVector(vec3);
+    void updateViewport(int width, int height);
+
+    const mat4& getView() const { if (dirty) update(); return view; }
+    const mat4& getProjection() const { if (dirty) update(); return projection; }
+    const mat4& getViewProjection() const { if (dirty) update(); return view_projection; }
+    // world space, normals pointing into the frustum and of unit length
+    const plane* getFrustumPlanes() const { if (dirty) update(); return planes; }
+    // changes whenever the matrices do, to skip uploading unchanged uniforms
+    unsigned getVersion() const { return changes; }
+
+    // false only if the sphere / box is entirely outside one of the planes;
+    // a shape near a corner of the frustum can pass and still be out of view
+    bool sphereVisible(vec3 centre, float radius) const;
+    bool boxVisible(vec3 low, vec3 high) const;
 };
+
+#endif
@@ -0,0 +1,20 @@
+#include <string.h>
+#include "ChunkMaze.h"
+#include "EllerMaze.h"
+
+void ChunkMaze::blocks(int cx, int cz, unsigned char* out) const {
+  const int b = blockSize();
+  memset(out, 1, b * b);
+  int west = westDoor(cx, cz), north = northDoor(cx, cz);
+
+  EllerMaze eller(n, chunkSeed(cx, cz));
+  eller.generate(n, [&](int j, const unsigned char* cells) {
+    for (int i = 0; i < n; i++) {
+      out[(2 * j + 1) * b + 2 * i + 1] = 0;
+      if (i + 1 < n && (cells[i] & 1)) out[(2 * j + 1) * b + 2 * i + 2] = 0;
+      if (j + 1 < n && (cells[i] & 2)) out[(2 * j + 2) * b + 2 * i + 1] = 0;
+    }
+  });
+  out[(2 * west + 1) * b] = 0;
+  out[2 * north + 1] = 0;
+}
@@ -0,0 +1,44 @@
+#ifndef CHUNK_MAZE_H
+#define CHUNK_MAZE_H
+
+// An unbounded maze split into square chunks of cells x cells. Any chunk can
+// be built on its own, in any order and on any thread, and always comes out
+// the same for the same seed:
+//  - inside a chunk the cells form a perfect maze (EllerMaze seeded from the
+//    world seed and the chunk coordinates)
+//  - the west and north edges of a chunk each have one opening, placed by a
+//    hash of the seed and chunk coordinates; a chunk's east and south
+//    openings are its neighbours' west and north ones, so seams always agree
+//    and every chunk is reachable from every other.
+//
+// blocks() renders a chunk as a 2*cells x 2*cells block map: cell (i,j) is
+// block (2i+1, 2j+1), the blocks between cells are walls or passages, and
+// block row/column 0 is the chunk's north/west edge.
+class ChunkMaze {
+  public:
+    ChunkMaze(unsigned long long seed, int cells) : seed(seed), n(cells) {}
+
+    int cells() const { return n; }
+    int blockSize() const { return 2 * n; }
+
+    unsigned long long chunkSeed(int cx, int cz) const { return hash(cx, cz, 0); }
+    int westDoor(int cx, int cz) const { return (int)(hash(cx, cz, 1) % n); }   // cell row
+    int northDoor(int cx, int cz) const { return (int)(hash(cx, cz, 2) % n); }  // cell column
+
+    // out[bz * blockSize() + bx] = 1 for a wall block, 0 for an open one
+    void blocks(int cx, int cz, unsigned char* out) const;
+
+  private:
+    unsigned long long seed;
+    int n;
+
+    unsigned long long hash(int cx, int cz, unsigned salt) const {
+      unsigned long long h = seed ^ ((unsigned long long)(unsigned)cx << 32 | (unsigned)cz);
+      h += 0x9e3779b97f4a7c15ULL * (salt + 1);
+      h = (h ^ (h >> 30)) * 0xbf58476d1ce4e5b9ULL;
+      h = (h ^ (h >> 27)) * 0x94d049bb133111ebULL;
+      return h ^ (h >> 31);
+    }
+};
+
+#endif
@@ -0,0 +1,118 @@
+#ifndef CIRCLE_SWEEP_H
+#define CIRCLE_SWEEP_H
+
+#include <math.h>
+
+// Moves a circle through a grid of square wall blocks without ever entering
+// one, however far it moves in a step.
+//
+// The motion is split into its x and its z part and each part is swept on
+// its own: the blocks the circle's leading side passes are walked one column
+// at a time (a DDA walk along the axis), and the move stops where the circle
+// first touches a wall. A face stops the circle where its edge touches it, a
+// block corner where the round side does, so the circle rolls past corners
+// it only grazes. A move into a wall at an angle loses only the blocked part
+// and the player slides along the wall.
+//
+// The walls come from a functor, isWall(bx, bz), so the same code serves
+// maze[][], the chunked world and anything else with integer blocks. Nothing
+// is allocated and a step costs a few lookups per block crossed, cheap enough
+// to move thousands of agents every tick.
+//
+//   SweepGrid blocks(2, 1);  // blocks 2 wide, block b spans [2b - 1, 2b + 1]
+//   sweepCircle(&x, &z, dx, dz, 0.5f, blocks, isWall);
+//
+// The radius must be less than half a block. A circle that already overlaps
+// a wall can still move away from it, never further in.
+
+struct SweepGrid {
+  float size;    // side of a block in world units
+  float offset;  // block b spans [b * size - offset, (b + 1) * size - offset]
+  SweepGrid(float size = 1, float offset = 0) : size(size), offset(offset) {}
+
+  int block(float p) const { return (int)floorf((p + offset) / size); }
+  float low(int b) const { return b * size - offset; }
+  float high(int b) const { return (b + 1) * size - offset; }
+};
+
+enum { SWEEP_BLOCKED_X = 1, SWEEP_BLOCKED_Z = 2 };
+
+namespace sweep {
+
+// how far inside a wall a touch still counts as sliding past it, so rounding
+// never snags a circle that runs exactly along a face
+const float SKIN = 1e-4f;
+
+// how far 'pos' can move by 'delta' along one axis; 'other' is the position on
+// the other axis and wall(a, b) looks up block a along this axis, b along the other
+template <class Wall>
+float axis(float pos, float other, float delta, float radius, const SweepGrid& g, const Wall& wall) {
+  if (delta == 0) return pos;
+  const int dir = delta > 0 ? 1 : -1;
+  const float target = pos + delta;
+  const float r2 = radius * radius;
+  const int b0 = g.block(other - radius + SKIN), b1 = g.block(other + radius - SKIN);
+  const int last = g.block(target + dir * radius);
+  float stop = target;
+
+  for (int a = g.block(pos + dir * radius);; a += dir) {
+    // the face of this column the circle reaches first; nothing in it can
+    // stop the circle earlier than a flat touch of that face
+    const float face = dir > 0 ? g.low(a) : g.high(a);
+    if (dir * (face - dir * radius - stop) >= 0) break;
+    for (int b = b0; b <= b1; b++) {
+      if (!wall(a, b)) continue;
+      float touch;
+      if (other >= g.low(b) && other <= g.high(b)) {
+        touch = face - dir * radius;
+      } else {
+        float off = other - (other < g.low(b) ? g.low(b) : g.high(b));
+        float s = r2 - off * off;
+        if (s <= 2 * SKIN * radius) continue;
+        touch = face - dir * sqrtf(s);
+      }
+      // already overlapping this block: don't go any deeper
+      if (dir * (touch - pos) < 0) touch = pos;
+      if (dir * (touch - stop) < 0) stop = touch;
+    }
+    if (a == last) break;
+  }
+  return stop;
+}
+
+}  // namespace sweep
+
+// Moves (*x, *z) by (dx, dz), x first, then z. Returns SWEEP_BLOCKED_X and/or
+// SWEEP_BLOCKED_Z for the parts of the move a wall cut short
+template <class IsWall>
+unsigned sweepCircle(float* x, float* z, float dx, float dz, float radius, const SweepGrid& g, const IsWall& isWall) {
+  struct Swapped {
+    const IsWall& isWall;
+    bool operator()(int bz, int bx) const { return isWall(bx, bz); }
+  } swapped = {isWall};
+
+  unsigned blocked = 0;
+  float nx = sweep::axis(*x, *z, dx, radius, g, isWall);
+  if (nx != *x + dx) blocked |= SWEEP_BLOCKED_X;
+  *x = nx;
+  float nz = sweep::axis(*z, *x, dz, radius, g, swapped);
+  if (nz != *z + dz) blocked |= SWEEP_BLOCKED_Z;
+  *z = nz;
+  return blocked;
+}
+
+// does the circle at (x, z) overlap a wall
+template <class IsWall>
+bool circleHitsWall(float x, float z, float radius, const SweepGrid& g, const IsWall& isWall) {
+  const float r2 = radius * radius;
+  for (int a = g.block(x - radius + sweep::SKIN); a <= g.block(x + radius - sweep::SKIN); a++)
+    for (int b = g.block(z - radius + sweep::SKIN); b <= g.block(z + radius - sweep::SKIN); b++) {
+      if (!isWall(a, b)) continue;
+      float cx = x < g.low(a) ? g.low(a) : x > g.high(a) ? g.high(a) : x;
+      float cz = z < g.low(b) ? g.low(b) : z > g.high(b) ? g.high(b) : z;
+      if ((cx - x) * (cx - x) + (cz - z) * (cz - z) < r2 - 2 * sweep::SKIN * radius) return true;
+    }
+  return false;
+}
+
+#endif
@@ -0,0 +1,259 @@
+#include <algorithm>
+#include "DistanceField.h"
+
+using namespace std;
+
+const uint32_t DistanceField::UNREACHABLE;
+
+// gather the even bits of v into the low 32 bits
+static uint64_t evenBits(uint64_t v) {
+  v &= 0x5555555555555555ULL;
+  v = (v | v >> 1) & 0x3333333333333333ULL;
+  v = (v | v >> 2) & 0x0f0f0f0f0f0f0f0fULL;
+  v = (v | v >> 4) & 0x00ff00ff00ff00ffULL;
+  v = (v | v >> 8) & 0x0000ffff0000ffffULL;
+  return (v | v >> 16) & 0x00000000ffffffffULL;
+}
+
+DistanceField::DistanceField(const Grid& g)
+  : grid(g), w(g.width()), h(g.height()), rowWords((g.width() + 63) / 64), edges(0), bias(0),
+    srcX(-1), srcZ(-1), farX(-1), farZ(-1), tree(false) {
+  size_t words = rowWords * h;
+  east.assign(words, 0);
+  south.assign(words, 0);
+  dist.assign((size_t)w * h, UNREACHABLE);
+  frontier.assign(words, 0);
+  next.assign(words, 0);
+  seen.assign(words, 0);
+}
+
+void DistanceField::extractEdges() {
+  fill(east.begin(), east.end(), 0);
+  fill(south.begin(), south.end(), 0);
+  if (grid.getLayout() == Grid::ROW_MAJOR) {
+    // a grid word is 32 cells of one row, bit 2k east and bit 2k+1 south of cell k
+    const uint64_t* cells = grid.data();
+    size_t gridWords = (w + 31) / 32;
+    for (int z = 0; z < h; z++)
+      for (size_t j = 0; j < gridWords; j++) {
+        uint64_t v = cells[z * gridWords + j];
+        size_t word = z * rowWords + j / 2;
+        unsigned shift = (j % 2) * 32;
+        east[word] |= evenBits(v) << shift;
+        south[word] |= evenBits(v >> 1) << shift;
+      }
+  }
+  else {
+    for (int z = 0; z < h; z++)
+      for (int x = 0; x < w; x++) {
+        size_t word = z * rowWords + x / 64;
+        if (grid.passage(x, z, Grid::EAST)) east[word] |= (uint64_t)1 << (x % 64);
+        if (grid.passage(x, z, Grid::SOUTH)) south[word] |= (uint64_t)1 << (x % 64);
+      }
+  }
+  edges = 0;
+  for (size_t i = 0; i < east.size(); i++) edges += __builtin_popcountll(east[i]) + __builtin_popcountll(south[i]);
+}
+
+void DistanceField::compute(int x, int z) {
+  computeQueue(x, z);
+}
+
+void DistanceField::computeQueue(int x, int z) {
+  extractEdges();
+  searchQueue(x, z);
+}
+
+void DistanceField::computeBits(int x, int z) {
+  extractEdges();
+  searchBits(x, z);
+}
+
+void DistanceField::searchBits(int x, int z) {
+  fill(dist.begin(), dist.end(), UNREACHABLE);
+  fill(seen.begin(), seen.end(), 0);
+  bias = 0;
+  srcX = x;
+  srcZ = z;
+  farX = farZ = -1;
+  tree = false;
+  if (!grid.inside(x, z)) return;
+
+  size_t start = z * rowWords + x / 64;
+  frontier[start] = seen[start] = (uint64_t)1 << (x % 64);
+  dist[(size_t)z * w + x] = 0;
+  farX = x;
+  farZ = z;
+  active.assign(1, start);
+  size_t reached = 1;
+  for (uint32_t level = 1; !active.empty(); level++) {
+    // push one step from every frontier word into itself and its four neighbour
+    // words, 64 cells at a time; 'touched' collects the words that got something
+    touched.clear();
+    for (size_t a = 0; a < active.size(); a++) {
+      uint32_t c = active[a];
+      size_t i = c % rowWords;
+      uint64_t f = frontier[c];
+      uint64_t out[5] = {((f & east[c]) << 1) | ((f >> 1) & east[c]), 0, 0, 0, 0};
+      uint32_t to[5] = {c, c - 1, c + 1, (uint32_t)(c - rowWords), (uint32_t)(c + rowWords)};
+      if (i > 0) out[1] = (f << 63) & east[c - 1];
+      if (i + 1 < rowWords) out[2] = (f & east[c]) >> 63;
+      if (c >= rowWords) out[3] = f & south[c - rowWords];
+      if (c + rowWords < frontier.size()) out[4] = f & south[c];
+      for (int k = 0; k < 5; k++) {
+        if (!out[k]) continue;  // before the lookup, 'to' is out of range at the edges
+        uint64_t n = out[k] & ~seen[to[k]];
+        if (!n) continue;
+        if (!next[to[k]]) touched.push_back(to[k]);
+        next[to[k]] |= n;
+      }
+    }
+
+    for (size_t a = 0; a < active.size(); a++) frontier[active[a]] = 0;
+    active.swap(touched);
+    for (size_t a = 0; a < active.size(); a++) {
+      uint32_t c = active[a];
+      uint64_t n = next[c];
+      next[c] = 0;
+      seen[c] |= n;
+      frontier[c] = n;
+      size_t row = c / rowWords, base = row * w + (c % rowWords) * 64;
+      for (; n; n &= n - 1) {
+        dist[base + __builtin_ctzll(n)] = level;
+        reached++;
+      }
+      farX = (c % rowWords) * 64 + __builtin_ctzll(frontier[c]);
+      farZ = row;
+    }
+  }
+  tree = reached == (size_t)w * h && edges + 1 == reached;
+}
+
+void DistanceField::searchQueue(int x, int z) {
+  fill(dist.begin(), dist.end(), UNREACHABLE);
+  bias = 0;
+  srcX = x;
+  srcZ = z;
+  farX = farZ = -1;
+  tree = false;
+  if (!grid.inside(x, z)) return;
+
+  active.assign(1, (uint32_t)(z * w + x));
+  dist[(size_t)z * w + x] = 0;
+  for (size_t head = 0; head < active.size(); head++) {
+    uint32_t c = active[head];
+    int cx = c % w, cz = c / w;
+    size_t word = cz * rowWords + cx / 64;
+    unsigned bit = cx % 64;
+    uint32_t step = dist[c] + 1;
+    uint32_t around[4];
+    int n = 0;
+    if (east[word] >> bit & 1) around[n++] = c + 1;
+    if (cx > 0 && (east[(cz * rowWords) + (cx - 1) / 64] >> ((cx - 1) % 64) & 1)) around[n++] = c - 1;
+    if (south[word] >> bit & 1) around[n++] = c + w;
+    if (cz > 0 && (south[word - rowWords] >> bit & 1)) around[n++] = c - w;
+    for (int k = 0; k < n; k++)
+      if (dist[around[k]] == UNREACHABLE) {
+        dist[around[k]] = step;
+        active.push_back(around[k]);
+      }
+  }
+  farX = active.back() % w;
+  farZ = active.back() / w;
+  tree = active.size() == (size_t)w * h && edges + 1 == active.size();
+  active.clear();
+}
+
+void DistanceField::moveSource(int x, int z) {
+  int d = -1;
+  for (int k = 0; k < 4; k++)
+    if (srcX + Grid::dx(k) == x && srcZ + Grid::dz(k) == z) d = k;
+  if (!tree || d < 0 || !grid.passage(srcX, srcZ, d)) {
+    compute(x, z);
+    return;
+  }
+
+  // Without the edge crossed, a perfect maze falls into the side the source moved
+  // to (A), whose cells are now one step closer, and the rest (B), one step further.
+  // Walk both sides together and stop when one is done, then adjust the smaller
+  // one and move 'bias' for everything else.
+  uint64_t a0 = (uint64_t)z * w + x, b0 = (uint64_t)srcZ * w + srcX;
+  sideA.assign(1, a0 * 4 + Grid::opposite(d));
+  sideB.assign(1, b0 * 4 + d);
+  size_t ia = 0, ib = 0;
+  while (ia < sideA.size() && ib < sideB.size()) {
+    for (int s = 0; s < 2; s++) {
+      vector<uint64_t>& side = s ? sideB : sideA;
+      uint64_t e = side[s ? ib++ : ia++];
+      uint64_t c = e / 4;
+      int cx = c % w, cz = c / w;
+      unsigned open = grid.openMask(cx, cz) & ~(1u << (e % 4));
+      for (int k = 0; k < 4; k++)
+        if (open >> k & 1)
+          side.push_back(((uint64_t)(cz + Grid::dz(k)) * w + cx + Grid::dx(k)) * 4 + Grid::opposite(k));
+    }
+  }
+  if (ia == sideA.size()) {
+    for (size_t i = 0; i < sideA.size(); i++) dist[sideA[i] / 4] -= 2;
+    bias += 1;
+  }
+  else {
+    for (size_t i = 0; i < sideB.size(); i++) dist[sideB[i] / 4] += 2;
+    bias -= 1;
+  }
+  srcX = x;
+  srcZ = z;
+  farX = farZ = -1;
+}
+
+int DistanceField::towardSource(int x, int z) const {
+  uint32_t here = distance(x, z);
+  if (here == 0 || here == UNREACHABLE) return -1;
+  unsigned open = grid.openMask(x, z);
+  for (int d = 0; d < 4; d++)
+    if ((open >> d & 1) && distance(x + Grid::dx(d), z + Grid::dz(d)) == here - 1) return d;
+  return -1;
+}
+
+vector<uint32_t> DistanceField::path(int x, int z) const {
+  vector<uint32_t> cells;
+  if (distance(x, z) == UNREACHABLE) return cells;
+  cells.reserve(distance(x, z) + 1);
+  cells.push_back(z * w + x);
+  for (int d; (d = towardSource(x, z)) >= 0; ) {
+    x += Grid::dx(d);
+    z += Grid::dz(d);
+    cells.push_back(z * w + x);
+  }
+  return cells;
+}
+
+uint32_t DistanceField::farthest(int* x, int* z) {
+  if (farX < 0) {
+    // not known since a moveSource, or the source is outside the grid
+    flatten();
+    size_t best = dist.size();
+    for (size_t c = 0; c < dist.size(); c++)
+      if (dist[c] != UNREACHABLE && (best == dist.size() || dist[c] > dist[best])) best = c;
+    if (best == dist.size()) {
+      *x = *z = -1;
+      return UNREACHABLE;
+    }
+    farX = best % w;
+    farZ = best / w;
+  }
+  *x = farX;
+  *z = farZ;
+  return distance(farX, farZ);
+}
+
+void DistanceField::flatten() {
+  if (bias == 0) return;
+  for (size_t c = 0; c < dist.size(); c++) dist[c] += bias;
+  bias = 0;
+}
+
+const uint32_t* DistanceField::data() {
+  flatten();
+  return dist.data();
+}
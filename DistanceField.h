@@ -0,0 +1,77 @@
+#ifndef DISTANCE_FIELD_H
+#define DISTANCE_FIELD_H
+
+#include <stdint.h>
+#include <vector>
+#include "Grid.h"
+
+// Breadth first distances over the passages of a Grid, from one source cell
+// to every other cell. Once computed, the distance from any cell and the
+// first step of its shortest path back to the source are O(1) lookups, so a
+// hint arrow or a chasing enemy costs nothing per frame.
+//
+// The passages are first extracted into east/south bitsets, 64 cells per
+// word. computeQueue() is a plain FIFO over them. computeBits() runs the
+// search on bitsets too: each BFS level pushes every frontier word into its
+// four neighbour words, 64 cells at a time. Neither wins reliably, perfect
+// or braided (see BM_distanceField), so compute() uses the queue.
+//
+// When the source moves to a neighbouring cell of a perfect maze (what the
+// generators build), moveSource() updates the field without a new search:
+// every cell gets one step closer or one step further, depending on which
+// side of the crossed edge it lies, and only the smaller side is walked.
+//
+// The field reads the grid it was built from, which must outlive it; after
+// the grid changes, compute again.
+class DistanceField {
+  public:
+    static const uint32_t UNREACHABLE = 0xffffffff;
+
+    explicit DistanceField(const Grid& grid);
+
+    // computeQueue(); the bitset search is there to compare against
+    void compute(int x, int z);
+    void computeQueue(int x, int z);
+    void computeBits(int x, int z);
+    // the source moved to (x,z); incremental for a step across an open edge of a perfect maze
+    void moveSource(int x, int z);
+
+    int sourceX() const { return srcX; }
+    int sourceZ() const { return srcZ; }
+
+    // bias is only ever non-zero for a perfect maze, where nothing is unreachable
+    uint32_t distance(int x, int z) const { return dist[(size_t)z * w + x] + bias; }
+    // direction of the neighbour one step closer to the source, -1 at the source or if unreachable
+    int towardSource(int x, int z) const;
+    // cells from (x,z) to the source, both included, as z * width + x; empty if unreachable
+    std::vector<uint32_t> path(int x, int z) const;
+    // one of the cells furthest from the source, returns its distance
+    uint32_t farthest(int* x, int* z);
+
+    // the field in row-major order, for saveMaze
+    const uint32_t* data();
+
+  private:
+    const Grid& grid;
+    int w, h;
+    size_t rowWords;                 // 64-bit words per row of the bitsets
+    std::vector<uint64_t> east, south;  // bit set if that edge of the cell is open
+    uint64_t edges;                  // open edges in total
+    std::vector<uint32_t> dist;      // distance - bias
+    uint32_t bias;
+    int srcX, srcZ;
+    int farX, farZ;                  // -1 when unknown
+    bool tree;                       // edges == cells - 1 and all reachable, moveSource can be incremental
+
+    // bit-parallel search state, kept between computes
+    std::vector<uint64_t> frontier, next, seen;
+    std::vector<uint32_t> active, touched;
+    std::vector<uint64_t> sideA, sideB;  // moveSource walks, cell * 4 + direction back
+
+    void extractEdges();
+    void searchQueue(int x, int z);
+    void searchBits(int x, int z);
+    void flatten();
+};
+
+#endif
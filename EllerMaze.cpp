@@ -0,0 +1,63 @@
+#include "EllerMaze.h"
+
+using namespace std;
+
+EllerMaze::EllerMaze(int width, unsigned long long seed)
+  : w(width), z(0), rng(seed), label(width, -1), parent(width), owner(width),
+    count(width), candidate(width), cells(width) {}
+
+int EllerMaze::find(int x) {
+  while (parent[x] != x) {
+    parent[x] = parent[parent[x]];
+    x = parent[x];
+  }
+  return x;
+}
+
+const unsigned char* EllerMaze::nextRow(bool last) {
+  // cells that came down from the row above keep its set, the others start one of their own;
+  // sets are named by a cell position so the labels never grow past the width
+  fill(owner.begin(), owner.end(), -1);
+  for (int x = 0; x < w; x++) {
+    int l = label[x];
+    if (l < 0 || owner[l] < 0) {
+      parent[x] = x;
+      if (l >= 0) owner[l] = x;
+    }
+    else parent[x] = owner[l];
+    cells[x] = 0;
+  }
+
+  // join neighbours of different sets at random, or all of them on the last row
+  for (int x = 0; x + 1 < w; x++) {
+    int a = find(x), b = find(x + 1);
+    if (a != b && (last || rng.below(2))) {
+      parent[b] = a;
+      cells[x] |= 1;
+    }
+  }
+
+  if (last) {
+    for (int x = 0; x < w; x++) label[x] = -1;
+    z++;
+    return cells.data();
+  }
+
+  // every set goes down at least once: random cells go down, and a set that got
+  // none sends the cell picked for it by reservoir sampling
+  fill(count.begin(), count.end(), 0);
+  for (int x = 0; x < w; x++) {
+    int r = find(x);
+    if (rng.below(2)) {
+      cells[x] |= 2;
+      count[r] = -1;  // this set is connected downwards already
+    }
+    else if (count[r] >= 0 && rng.below(++count[r]) == 0) candidate[r] = x;
+  }
+  for (int x = 0; x < w; x++)
+    if (parent[x] == x && count[x] > 0) cells[candidate[x]] |= 2;
+
+  for (int x = 0; x < w; x++) label[x] = (cells[x] & 2) ? find(x) : -1;
+  z++;
+  return cells.data();
+}
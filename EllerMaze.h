@@ -0,0 +1,48 @@
+#ifndef ELLER_MAZE_H
+#define ELLER_MAZE_H
+
+#include <vector>
+#include "Random.h"
+
+// Streaming maze generator (Eller's algorithm). Rows come out one at a time
+// and only the current row is kept, so memory is proportional to the width
+// and the maze can be as long as needed. Every row is a width sized array of
+// cells in the Grid encoding: bit 0 set if the east edge is open, bit 1 if
+// the south edge is open. The same seed always gives the same rows.
+//
+//   EllerMaze eller(width, seed);
+//   eller.generate(height, [&](int z, const unsigned char* cells) { ... });
+class EllerMaze {
+  public:
+    EllerMaze(int width, unsigned long long seed);
+
+    int width() const { return w; }
+    int row() const { return z; }  // index of the next row
+
+    // the next row; 'last' closes the maze so it stays a single spanning tree.
+    // The returned cells are valid until the next call.
+    const unsigned char* nextRow(bool last = false);
+
+    // emit(z, cells) for 'height' more rows, the last one closing the maze
+    template <class Emit> void generate(int height, Emit emit) {
+      for (int i = 0; i < height; i++) {
+        int row = z;
+        const unsigned char* cells = nextRow(i == height - 1);
+        emit(row, cells);
+      }
+    }
+
+  private:
+    int w, z;
+    Random rng;
+    std::vector<int> label;      // set of each cell carried down from the previous row, -1 for none
+    std::vector<int> parent;     // union-find over the cells of the current row
+    std::vector<int> owner;      // first cell of the current row seen with a given label
+    std::vector<int> count;      // cells seen per set, for picking a random one
+    std::vector<int> candidate;  // the cell picked so far to go down, per set
+    std::vector<unsigned char> cells;
+
+    int find(int x);
+};
+
+#endif
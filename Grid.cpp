@@ -0,0 +1,83 @@
+#include <string.h>
+#include <utility>
+#include "Grid.h"
+
+static size_t strideFor(int w, Grid::Layout layout) {
+  return layout == Grid::ROW_MAJOR ? (w + 31) / 32 : (w + 7) / 8;
+}
+
+size_t Grid::wordCount(int width, int height, Layout layout) {
+  size_t rows = layout == ROW_MAJOR ? height : (height + 3) / 4;
+  return rows * strideFor(width, layout);
+}
+
+Grid::Grid(int width, int height, Layout l) : w(width), h(height), layout(l) {
+  stride = strideFor(w, layout);
+  words.assign(wordCount(w, h, layout), 0);
+  bits = words.empty() ? NULL : &words[0];
+  count = words.size();
+}
+
+Grid Grid::wrap(int width, int height, Layout layout, uint64_t* storage) {
+  Grid grid;
+  grid.w = width;
+  grid.h = height;
+  grid.layout = layout;
+  grid.stride = strideFor(width, layout);
+  grid.bits = storage;
+  grid.count = wordCount(width, height, layout);
+  return grid;
+}
+
+Grid::Grid(Grid&& other)
+  : w(other.w), h(other.h), layout(other.layout), stride(other.stride), words(std::move(other.words)),
+    bits(other.bits), count(other.count) {
+  other.w = other.h = 0;
+  other.stride = 0;
+  other.bits = NULL;
+  other.count = 0;
+}
+
+Grid& Grid::operator=(Grid&& other) {
+  w = other.w;
+  h = other.h;
+  layout = other.layout;
+  stride = other.stride;
+  words = std::move(other.words);
+  bits = other.bits;
+  count = other.count;
+  other.w = other.h = 0;
+  other.stride = 0;
+  other.bits = NULL;
+  other.count = 0;
+  return *this;
+}
+
+Grid Grid::clone() const {
+  Grid copy;
+  copy.w = w;
+  copy.h = h;
+  copy.layout = layout;
+  copy.stride = stride;
+  copy.words.assign(bits, bits + count);
+  copy.bits = copy.words.empty() ? NULL : &copy.words[0];
+  copy.count = count;
+  return copy;
+}
+
+void Grid::setPassage(int x, int z, int d, bool open) {
+  // store the edge on the cell that owns it: west/north belong to the neighbour
+  unsigned bit = 1;
+  if (d == WEST) x--;
+  else if (d == NORTH) z--;
+  if (d == SOUTH || d == NORTH) bit = 2;
+  size_t word;
+  unsigned shift;
+  locate(x, z, &word, &shift);
+  if (open) bits[word] |= (uint64_t)bit << shift;
+  else bits[word] &= ~((uint64_t)bit << shift);
+}
+
+void Grid::clear() {
+  if (count) memset(bits, 0, count * sizeof(uint64_t));
+}
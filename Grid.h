@@ -0,0 +1,102 @@
+#ifndef GRID_H
+#define GRID_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <vector>
+
+// Maze grid sized at runtime. Each cell stores 2 bits: whether its east edge
+// and its south edge are open; the west and north edges are the east/south
+// edges of the neighbours, and the outer border is always a wall. A fresh
+// grid is all walls. 10000 x 10000 cells take 25 MB.
+//
+// ROW_MAJOR packs 32 cells of a row into each 64-bit word. TILED packs 8x4
+// cell tiles into each word, so north/south neighbours usually share a word
+// with the cell, which suits walks that wander in both axes.
+//
+// Grids can be large so copying is explicit (clone()); they move cheaply.
+// wrap() puts a grid over words that live elsewhere (a memory mapped maze
+// file, see MazeFile.h) instead of allocating its own.
+class Grid {
+  public:
+    enum Direction { NORTH = 0, EAST = 1, SOUTH = 2, WEST = 3 };  // NORTH is -z, EAST is +x
+    enum Layout { ROW_MAJOR, TILED };
+
+    Grid() : w(0), h(0), layout(ROW_MAJOR), stride(0), bits(NULL), count(0) {}
+    Grid(int width, int height, Layout layout = ROW_MAJOR);
+    // 'storage' must hold wordCount(width, height, layout) words and outlive the grid
+    static Grid wrap(int width, int height, Layout layout, uint64_t* storage);
+    Grid(Grid&& other);
+    Grid& operator=(Grid&& other);
+    // copies are made with clone(), never by accident
+    Grid(const Grid&) = delete;
+    Grid& operator=(const Grid&) = delete;
+    Grid clone() const;
+
+    int width() const { return w; }
+    int height() const { return h; }
+    Layout getLayout() const { return layout; }
+    size_t bytes() const { return count * sizeof(uint64_t); }
+
+    // the packed cells, for saving and loading
+    static size_t wordCount(int width, int height, Layout layout);
+    const uint64_t* data() const { return bits; }
+
+    static int dx(int d) { return d == EAST ? 1 : d == WEST ? -1 : 0; }
+    static int dz(int d) { return d == SOUTH ? 1 : d == NORTH ? -1 : 0; }
+    static int opposite(int d) { return d ^ 2; }
+
+    bool inside(int x, int z) const { return x >= 0 && z >= 0 && x < w && z < h; }
+
+    // is the edge from (x,z) towards d open; false outside the grid
+    bool passage(int x, int z, int d) const {
+      switch (d) {
+        case EAST:  return inside(x, z) && (cell(x, z) & 1);
+        case SOUTH: return inside(x, z) && (cell(x, z) & 2);
+        case WEST:  return inside(x - 1, z) && x < w && (cell(x - 1, z) & 1);
+        default:    return inside(x, z - 1) && z < h && (cell(x, z - 1) & 2);
+      }
+    }
+
+    // open edges of (x,z), bit d set for every open direction d
+    unsigned openMask(int x, int z) const {
+      unsigned c = cell(x, z);
+      unsigned mask = ((c & 1) << EAST) | ((c & 2) << (SOUTH - 1));
+      if (x > 0 && (cell(x - 1, z) & 1)) mask |= 1 << WEST;
+      if (z > 0 && (cell(x, z - 1) & 2)) mask |= 1 << NORTH;
+      return mask;
+    }
+
+    // open (carve) or close the edge from (x,z) towards d, the neighbour must be inside
+    void setPassage(int x, int z, int d, bool open);
+    void carve(int x, int z, int d) { setPassage(x, z, d, true); }
+
+    // make every edge a wall again
+    void clear();
+
+  private:
+    int w, h;
+    Layout layout;
+    size_t stride;  // words per row of cells (ROW_MAJOR) or per row of tiles (TILED)
+    std::vector<uint64_t> words;  // own storage, empty for a wrapped grid
+    uint64_t* bits;               // words.data() or the wrapped storage
+    size_t count;
+
+    void locate(int x, int z, size_t* word, unsigned* shift) const {
+      if (layout == ROW_MAJOR) {
+        *word = z * stride + (x >> 5);
+        *shift = (x & 31) * 2;
+      } else {
+        *word = (z >> 2) * stride + (x >> 3);
+        *shift = ((z & 3) * 8 + (x & 7)) * 2;
+      }
+    }
+    unsigned cell(int x, int z) const {
+      size_t word;
+      unsigned shift;
+      locate(x, z, &word, &shift);
+      return (bits[word] >> shift) & 3;
+    }
+};
+
+#endif
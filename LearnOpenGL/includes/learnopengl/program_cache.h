@@ -0,0 +1,114 @@
+#ifndef PROGRAM_CACHE_H
+#define PROGRAM_CACHE_H
+
+#include <glad/glad.h>
+#include <learnopengl/program_cache_format.h>
+
+#include <cstdio>
+#include <string>
+#include <vector>
+#include <sys/stat.h>
+
+// Keeps linked program binaries on disk (GL 4.1 glGetProgramBinary) so a warm
+// start skips shader compilation. Entries are keyed on the shader sources plus
+// the GL vendor, renderer and version strings; a binary the driver rejects is
+// deleted and the program is compiled from source again.
+// The files are the game's program_cache.cpp format (program_cache_format.h),
+// in $SHADER_CACHE_DIR, or ./.shader_cache by default.
+class ProgramCache
+{
+public:
+    // hash of the driver strings and every (stage, source) pair of a program
+    static unsigned long long key(const std::vector<std::pair<GLenum, std::string> >& stages)
+    {
+        unsigned long long hash = program_cache_key_begin((const char*)glGetString(GL_VENDOR),
+                                                          (const char*)glGetString(GL_RENDERER),
+                                                          (const char*)glGetString(GL_VERSION));
+        for (size_t i = 0; i < stages.size(); i++)
+        {
+            hash = program_cache_hash(hash, &stages[i].first, sizeof(GLenum));
+            hash = program_cache_hash_str(hash, stages[i].second.c_str());
+        }
+        return hash;
+    }
+    // call before glLinkProgram so the driver keeps the binary around
+    static void prepare(GLuint program)
+    {
+        if (supported())
+            glProgramParameteri(program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+    }
+    // true if the program was linked from the cache
+    static bool load(GLuint program, unsigned long long key)
+    {
+        if (!supported())
+            return false;
+        std::string path = pathFor(key);
+        FILE* in = fopen(path.c_str(), "rb");
+        if (!in)
+            return false;
+        program_cache_header header;
+        std::vector<char> binary;
+        bool ok = fread(&header, sizeof(header), 1, in) == 1 && program_cache_header_valid(&header, key);
+        if (ok)
+        {
+            binary.resize(header.length);
+            ok = fread(&binary[0], 1, header.length, in) == (size_t)header.length;
+        }
+        fclose(in);
+        GLint linked = GL_FALSE;
+        if (ok)
+        {
+            glProgramBinary(program, header.format, &binary[0], header.length);
+            glGetProgramiv(program, GL_LINK_STATUS, &linked);
+        }
+        if (!linked)
+            remove(path.c_str());
+        return linked == GL_TRUE;
+    }
+    // write the binary of a successfully linked program
+    static void store(GLuint program, unsigned long long key)
+    {
+        GLint linked = GL_FALSE;
+        glGetProgramiv(program, GL_LINK_STATUS, &linked);
+        if (!supported() || !linked)
+            return;
+        program_cache_header header;
+        program_cache_header_init(&header, key);
+        GLint length = 0;
+        glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+        if (length <= 0)
+            return;
+        std::vector<char> binary(length);
+        GLenum format = 0;
+        glGetProgramBinary(program, length, NULL, &format, &binary[0]);
+        header.length = length;
+        header.format = format;
+
+        mkdir(program_cache_dir(), 0755);
+        std::string path = pathFor(key), tmp = path + ".tmp";
+        // written under a temporary name so a crash never leaves a torn entry
+        FILE* out = fopen(tmp.c_str(), "wb");
+        if (!out)
+            return;
+        bool ok = fwrite(&header, sizeof(header), 1, out) == 1 &&
+                  fwrite(&binary[0], 1, header.length, out) == (size_t)header.length;
+        if (fclose(out) == 0 && ok)
+            rename(tmp.c_str(), path.c_str());
+        else
+            remove(tmp.c_str());
+    }
+
+private:
+    static bool supported()
+    {
+        return GLAD_GL_VERSION_4_1 && glProgramBinary && glGetProgramBinary;
+    }
+    static std::string pathFor(unsigned long long key)
+    {
+        char path[512];
+        program_cache_path(key, path, sizeof(path));
+        return path;
+    }
+};
+
+#endif
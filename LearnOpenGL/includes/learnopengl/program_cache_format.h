@@ -0,0 +1,78 @@
+#ifndef PROGRAM_CACHE_FORMAT_H
+#define PROGRAM_CACHE_FORMAT_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// The on-disk layout of the program binary cache, shared by the game's
+// program_cache.cpp (GLEW) and learnopengl's ProgramCache (glad) so both
+// write the same files into the same directory. Only the GL calls differ
+// between the two; the header, the version, the key hashing and the file
+// names live here and nowhere else.
+//
+// A file is a program_cache_header followed by 'length' bytes of binary.
+// Keys start from program_cache_key_begin(), which folds in the version and
+// the driver strings, then hash every stage and link parameter with
+// program_cache_hash().
+
+// Bump when the file layout or the way keys are built changes
+#define PROGRAM_CACHE_VERSION 2
+
+struct program_cache_header {
+  char magic[4];          // "GLPB"
+  unsigned int version;   // PROGRAM_CACHE_VERSION
+  unsigned long long key;
+  unsigned int format;    // GLenum from glGetProgramBinary
+  int length;             // GLint, bytes of binary that follow
+};
+
+// FNV-1a
+inline unsigned long long program_cache_hash(unsigned long long hash, const void* data, size_t size) {
+  const unsigned char* p = (const unsigned char*)data;
+  for (size_t i = 0; i < size; i++) {
+    hash ^= p[i];
+    hash *= 1099511628211ULL;
+  }
+  return hash;
+}
+
+inline unsigned long long program_cache_hash_str(unsigned long long hash, const char* s) {
+  return s ? program_cache_hash(hash, s, strlen(s) + 1) : program_cache_hash(hash, "", 1);
+}
+
+// the glGetString(GL_VENDOR / GL_RENDERER / GL_VERSION) of the context
+inline unsigned long long program_cache_key_begin(const char* vendor, const char* renderer, const char* version) {
+  unsigned long long hash = 14695981039346656037ULL;
+  unsigned int format = PROGRAM_CACHE_VERSION;
+  hash = program_cache_hash(hash, &format, sizeof(format));
+  hash = program_cache_hash_str(hash, vendor);
+  hash = program_cache_hash_str(hash, renderer);
+  return program_cache_hash_str(hash, version);
+}
+
+inline void program_cache_header_init(struct program_cache_header* header, unsigned long long key) {
+  memcpy(header->magic, "GLPB", 4);
+  header->version = PROGRAM_CACHE_VERSION;
+  header->key = key;
+  header->format = 0;
+  header->length = 0;
+}
+
+// true if 'header' was written by this version for 'key'
+inline bool program_cache_header_valid(const struct program_cache_header* header, unsigned long long key) {
+  return memcmp(header->magic, "GLPB", 4) == 0 && header->version == PROGRAM_CACHE_VERSION &&
+         header->key == key && header->length > 0;
+}
+
+// $SHADER_CACHE_DIR, or ./.shader_cache by default
+inline const char* program_cache_dir() {
+  const char* dir = getenv("SHADER_CACHE_DIR");
+  return dir ? dir : "./.shader_cache";
+}
+
+inline void program_cache_path(unsigned long long key, char* path, size_t size) {
+  snprintf(path, size, "%s/%016llx.bin", program_cache_dir(), key);
+}
+
+#endif
@@ -0,0 +1,22 @@
+#ifndef SHADER_FILE_H
+#define SHADER_FILE_H
+
+#include <fstream>
+#include <string>
+
+// reads a whole shader file with a single read sized from the file length,
+// instead of copying it through a stringstream
+inline bool readShaderFile(const char* path, std::string& code)
+{
+    std::ifstream file(path, std::ios::in | std::ios::binary | std::ios::ate);
+    if (!file)
+        return false;
+    std::streamsize size = file.tellg();
+    if (size < 0)
+        return false;
+    code.resize((size_t)size);
+    file.seekg(0, std::ios::beg);
+    return size == 0 || file.read(&code[0], size);
+}
+
+#endif
@@ -0,0 +1,256 @@
+#include <algorithm>
+#include "MazeAlgorithms.h"
+#include "EllerMaze.h"
+
+using namespace std;
+
+namespace {
+
+// one bit per cell
+class CellSet {
+  public:
+    CellSet(int width, int height) : w(width), bits(((size_t)width * height + 63) / 64, 0) {}
+    bool has(int x, int z) const {
+      size_t c = (size_t)z * w + x;
+      return bits[c / 64] >> (c % 64) & 1;
+    }
+    void add(int x, int z) {
+      size_t c = (size_t)z * w + x;
+      bits[c / 64] |= (uint64_t)1 << (c % 64);
+    }
+    size_t bytes() const { return bits.size() * sizeof(uint64_t); }
+
+  private:
+    int w;
+    vector<uint64_t> bits;
+};
+
+// bit d set for every neighbour of (x,z) in direction d that is inside the
+// grid and is (member) or is not (!member) in 'set'
+unsigned neighbours(const Grid& grid, const CellSet& set, int x, int z, bool member) {
+  unsigned mask = 0;
+  for (int d = 0; d < 4; d++) {
+    int nx = x + Grid::dx(d), nz = z + Grid::dz(d);
+    if (grid.inside(nx, nz) && set.has(nx, nz) == member) mask |= 1u << d;
+  }
+  return mask;
+}
+
+int pickDirection(Random& rng, unsigned mask) {
+  return __builtin_ctz(rng.pickBit(mask));
+}
+
+}
+
+size_t generateBacktracker(Grid& grid, Random& rng) {
+  // randomized depth first search (recursive backtracker) with an explicit stack:
+  // every cell is entered once and left once, so time and memory are linear.
+  // Directions are pushed as 2 bits each, 32 per word, so even a stack holding
+  // every cell of a 10000 x 10000 maze stays at 25 MB
+  static const int order[4] = {Grid::WEST, Grid::EAST, Grid::SOUTH, Grid::NORTH};
+  int w = grid.width(), h = grid.height();
+  if (w <= 0 || h <= 0) return 0;
+  int x = w / 2, z = h - 1;  // start at the entrance in the middle of the last row
+  CellSet visited(w, h);
+  vector<uint64_t> stack;
+  size_t depth = 0;
+  visited.add(x, z);
+
+  while (true) {
+    int options[4], n = 0;
+    for (int k = 0; k < 4; k++) {
+      int nx = x + Grid::dx(order[k]), nz = z + Grid::dz(order[k]);
+      if (grid.inside(nx, nz) && !visited.has(nx, nz)) options[n++] = order[k];
+    }
+    if (n > 0) {
+      int d = options[rng.below(n)];
+      grid.carve(x, z, d);
+      x += Grid::dx(d);
+      z += Grid::dz(d);
+      visited.add(x, z);
+      size_t word = depth / 32, shift = (depth % 32) * 2;
+      if (word == stack.size()) stack.push_back(0);
+      stack[word] = (stack[word] & ~((uint64_t)3 << shift)) | ((uint64_t)d << shift);
+      depth++;
+    }
+    else {
+      if (depth == 0) break;
+      depth--;
+      int d = (stack[depth / 32] >> ((depth % 32) * 2)) & 3;
+      x -= Grid::dx(d);
+      z -= Grid::dz(d);
+    }
+  }
+  return visited.bytes() + stack.capacity() * sizeof(uint64_t);
+}
+
+size_t generateEller(Grid& grid, Random& rng) {
+  // the streaming generator (see EllerMaze.h) writing its rows into the grid
+  int w = grid.width(), h = grid.height();
+  if (w <= 0 || h <= 0) return 0;
+  EllerMaze eller(w, rng.next());
+  eller.generate(h, [&grid, w](int z, const unsigned char* cells) {
+    for (int x = 0; x < w; x++) {
+      if (cells[x] & 1) grid.carve(x, z, Grid::EAST);
+      if (cells[x] & 2) grid.carve(x, z, Grid::SOUTH);
+    }
+  });
+  return (size_t)w * (5 * sizeof(int) + 1);
+}
+
+size_t generateKruskal(Grid& grid, Random& rng) {
+  // every inner edge in random order, opened when it joins two different trees.
+  // Edges are numbered cell * 2 + 0 for east, + 1 for south
+  int w = grid.width(), h = grid.height();
+  if (w <= 0 || h <= 0) return 0;
+  uint32_t cells = (uint32_t)w * h;
+  vector<uint32_t> edges;
+  edges.reserve((size_t)cells * 2);
+  for (int z = 0; z < h; z++)
+    for (int x = 0; x < w; x++) {
+      uint32_t c = (uint32_t)z * w + x;
+      if (x + 1 < w) edges.push_back(c * 2);
+      if (z + 1 < h) edges.push_back(c * 2 + 1);
+    }
+  for (size_t i = edges.size(); i > 1; i--)
+    swap(edges[i - 1], edges[rng.below(i)]);
+
+  vector<uint32_t> parent(cells);
+  for (uint32_t c = 0; c < cells; c++) parent[c] = c;
+  uint32_t joined = 0;
+  for (size_t i = 0; i < edges.size() && joined + 1 < cells; i++) {
+    uint32_t a = edges[i] / 2, b = (edges[i] & 1) ? a + w : a + 1;
+    // find both roots, halving the paths on the way
+    while (parent[a] != a) a = parent[a] = parent[parent[a]];
+    while (parent[b] != b) b = parent[b] = parent[parent[b]];
+    if (a == b) continue;
+    parent[b] = a;
+    joined++;
+    uint32_t c = edges[i] / 2;
+    grid.carve(c % w, c / w, (edges[i] & 1) ? Grid::SOUTH : Grid::EAST);
+  }
+  return edges.capacity() * sizeof(uint32_t) + parent.capacity() * sizeof(uint32_t);
+}
+
+size_t generatePrim(Grid& grid, Random& rng) {
+  // grow from one random cell: a random frontier cell (outside the maze, next
+  // to it) is joined to a random neighbour already in the maze
+  int w = grid.width(), h = grid.height();
+  if (w <= 0 || h <= 0) return 0;
+  CellSet in(w, h), queued(w, h);
+  vector<uint32_t> frontier;
+  size_t peak = 0;
+  int x = rng.below(w), z = rng.below(h);
+
+  while (true) {
+    in.add(x, z);
+    unsigned out = neighbours(grid, in, x, z, false);
+    for (int d = 0; d < 4; d++) {
+      int nx = x + Grid::dx(d), nz = z + Grid::dz(d);
+      if ((out >> d & 1) && !queued.has(nx, nz)) {
+        queued.add(nx, nz);
+        frontier.push_back((uint32_t)nz * w + nx);
+      }
+    }
+    peak = max(peak, frontier.capacity());
+    if (frontier.empty()) break;
+
+    size_t i = rng.below(frontier.size());
+    uint32_t c = frontier[i];
+    frontier[i] = frontier.back();
+    frontier.pop_back();
+    x = c % w;
+    z = c / w;
+    grid.carve(x, z, pickDirection(rng, neighbours(grid, in, x, z, true)));
+  }
+  return in.bytes() + queued.bytes() + peak * sizeof(uint32_t);
+}
+
+size_t generateWilson(Grid& grid, Random& rng) {
+  // loop-erased random walks: from every cell not yet in the maze, walk at
+  // random until the maze is hit, then carve the walk. Only the last exit
+  // taken from each cell is kept, which erases the loops
+  int w = grid.width(), h = grid.height();
+  if (w <= 0 || h <= 0) return 0;
+  CellSet in(w, h);
+  vector<unsigned char> exit((size_t)w * h);
+  in.add(rng.below(w), rng.below(h));
+
+  for (int sz = 0; sz < h; sz++)
+    for (int sx = 0; sx < w; sx++) {
+      int x = sx, z = sz;
+      while (!in.has(x, z)) {
+        unsigned inside = (x + 1 < w) << Grid::EAST | (x > 0) << Grid::WEST |
+                          (z + 1 < h) << Grid::SOUTH | (z > 0) << Grid::NORTH;
+        int d = pickDirection(rng, inside);
+        exit[(size_t)z * w + x] = d;
+        x += Grid::dx(d);
+        z += Grid::dz(d);
+      }
+      x = sx;
+      z = sz;
+      while (!in.has(x, z)) {
+        int d = exit[(size_t)z * w + x];
+        in.add(x, z);
+        grid.carve(x, z, d);
+        x += Grid::dx(d);
+        z += Grid::dz(d);
+      }
+    }
+  return in.bytes() + exit.capacity();
+}
+
+size_t generateGrowingTree(Grid& grid, Random& rng) {
+  // a list of active cells, each step extends either the newest one (half of
+  // the time, like the backtracker) or a random one (like Prim); cells with
+  // no unvisited neighbour left are dropped
+  int w = grid.width(), h = grid.height();
+  if (w <= 0 || h <= 0) return 0;
+  CellSet visited(w, h);
+  vector<uint32_t> active;
+  size_t peak = 0;
+  int x = rng.below(w), z = rng.below(h);
+  visited.add(x, z);
+  active.push_back((uint32_t)z * w + x);
+
+  while (!active.empty()) {
+    size_t i = rng.below(2) ? active.size() - 1 : rng.below(active.size());
+    x = active[i] % w;
+    z = active[i] / w;
+    unsigned free = neighbours(grid, visited, x, z, false);
+    if (free) {
+      int d = pickDirection(rng, free);
+      grid.carve(x, z, d);
+      x += Grid::dx(d);
+      z += Grid::dz(d);
+      visited.add(x, z);
+      active.push_back((uint32_t)z * w + x);
+      peak = max(peak, active.capacity());
+    }
+    else {
+      active[i] = active.back();
+      active.pop_back();
+    }
+  }
+  return visited.bytes() + peak * sizeof(uint32_t);
+}
+
+vector<MazeAlgorithm>& mazeAlgorithms() {
+  static MazeAlgorithm builtin[] = {
+    {"backtracker", generateBacktracker},
+    {"eller", generateEller},
+    {"kruskal", generateKruskal},
+    {"prim", generatePrim},
+    {"wilson", generateWilson},
+    {"growing-tree", generateGrowingTree},
+  };
+  static vector<MazeAlgorithm> registry(builtin, builtin + sizeof(builtin) / sizeof(builtin[0]));
+  return registry;
+}
+
+const MazeAlgorithm* findMazeAlgorithm(const string& name) {
+  vector<MazeAlgorithm>& all = mazeAlgorithms();
+  for (size_t i = 0; i < all.size(); i++)
+    if (name == all[i].name) return &all[i];
+  return NULL;
+}
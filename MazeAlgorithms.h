@@ -0,0 +1,43 @@
+#ifndef MAZE_ALGORITHMS_H
+#define MAZE_ALGORITHMS_H
+
+#include <stddef.h>
+#include <string>
+#include <vector>
+#include "Grid.h"
+#include "Random.h"
+
+// Interchangeable maze generators. Each one follows the same contract: the
+// grid comes in all walls, a perfect maze (every cell reachable, exactly one
+// path between any two) is carved into it, and the result depends only on
+// the grid size and the state of 'rng'. generate() returns the peak number
+// of bytes of working memory it used on top of the grid itself.
+//
+// Rough cost per cell, n cells:
+//   backtracker   O(1), 2 bits of stack + 1 bit visited, long corridors
+//   eller         O(1), memory O(width) only, row by row
+//   kruskal       O(alpha(n)), an edge list and a union-find (12 bytes/cell)
+//   prim          O(1), frontier list (4 bytes/cell), many short dead ends
+//   wilson        O(n) expected walk steps in total but slow at the start,
+//                 the only uniformly random one (1 byte/cell)
+//   growing-tree  O(1), active list (4 bytes/cell), between backtracker and prim
+//
+// More generators can be appended to mazeAlgorithms() before use.
+struct MazeAlgorithm {
+  const char* name;
+  size_t (*generate)(Grid& grid, Random& rng);
+};
+
+std::vector<MazeAlgorithm>& mazeAlgorithms();
+
+// NULL if there is no generator called 'name'
+const MazeAlgorithm* findMazeAlgorithm(const std::string& name);
+
+size_t generateBacktracker(Grid& grid, Random& rng);
+size_t generateEller(Grid& grid, Random& rng);
+size_t generateKruskal(Grid& grid, Random& rng);
+size_t generatePrim(Grid& grid, Random& rng);
+size_t generateWilson(Grid& grid, Random& rng);
+size_t generateGrowingTree(Grid& grid, Random& rng);
+
+#endif
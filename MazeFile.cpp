@@ -0,0 +1,174 @@
+#include <stdio.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "MazeFile.h"
+
+using namespace std;
+
+#define MAZE_FILE_ALIGN 4096
+
+static_assert(sizeof(MazeFileHeader) == 128, "MazeFileHeader is part of the file format");
+
+static const uint64_t P1 = 0x9e3779b185ebca87ULL, P2 = 0xc2b2ae3d27d4eb4fULL,
+                      P3 = 0x165667b19e3779f9ULL, P4 = 0x85ebca77c2b2ae63ULL;
+
+static uint64_t rotl(uint64_t x, int k) { return (x << k) | (x >> (64 - k)); }
+
+uint64_t mazeChecksum(const void* data, size_t size) {
+  // xxHash64 style: four independent lanes keep the multiplier busy, then one mix
+  const unsigned char* p = (const unsigned char*)data;
+  uint64_t lane[4] = {P1 + P2, P2, 0, 0 - P1};
+  size_t i = 0;
+  for (; i + 32 <= size; i += 32)
+    for (int k = 0; k < 4; k++) {
+      uint64_t v;
+      memcpy(&v, p + i + 8 * k, 8);
+      lane[k] = rotl(lane[k] + v * P2, 31) * P1;
+    }
+  uint64_t h = rotl(lane[0], 1) + rotl(lane[1], 7) + rotl(lane[2], 12) + rotl(lane[3], 18) + size;
+  for (; i < size; i++) h = rotl(h ^ (p[i] * P3), 11) * P1;
+  h ^= h >> 33;
+  h *= P2;
+  h ^= h >> 29;
+  h *= P4;
+  return h ^ (h >> 32);
+}
+
+static uint64_t alignUp(uint64_t offset) {
+  return (offset + MAZE_FILE_ALIGN - 1) / MAZE_FILE_ALIGN * MAZE_FILE_ALIGN;
+}
+
+static bool writePadded(FILE* f, const void* data, size_t size, uint64_t end) {
+  static const char zeros[MAZE_FILE_ALIGN] = {0};
+  if (size && fwrite(data, 1, size, f) != size) return false;
+  for (uint64_t at = ftell(f); at < end; ) {
+    size_t n = end - at < sizeof(zeros) ? (size_t)(end - at) : sizeof(zeros);
+    if (fwrite(zeros, 1, n, f) != n) return false;
+    at += n;
+  }
+  return true;
+}
+
+bool saveMaze(const char* path, const Grid& grid, const MazeInfo& info, const uint32_t* distances) {
+  if (info.algorithm.size() >= sizeof(((MazeFileHeader*)0)->algorithm)) {
+    fprintf(stderr, "%s: algorithm name '%s' is too long\n", path, info.algorithm.c_str());
+    return false;
+  }
+  MazeFileHeader header;
+  memset(&header, 0, sizeof(header));
+  memcpy(header.magic, "MAZE", 4);
+  header.version = MAZE_FILE_VERSION;
+  header.byteOrder = 0x0102;
+  header.width = grid.width();
+  header.height = grid.height();
+  header.layout = grid.getLayout();
+  header.diamondX = info.diamondX;
+  header.diamondZ = info.diamondZ;
+  header.seed = info.seed;
+  strcpy(header.algorithm, info.algorithm.c_str());
+  header.wallsOffset = MAZE_FILE_ALIGN;
+  header.wallsBytes = grid.bytes();
+  header.wallsChecksum = mazeChecksum(grid.data(), grid.bytes());
+  if (distances) {
+    header.distancesOffset = alignUp(header.wallsOffset + header.wallsBytes);
+    header.distancesBytes = (uint64_t)grid.width() * grid.height() * sizeof(uint32_t);
+    header.distancesChecksum = mazeChecksum(distances, header.distancesBytes);
+  }
+  header.headerChecksum = mazeChecksum(&header, sizeof(header));
+
+  string tmp = string(path) + ".tmp";
+  FILE* f = fopen(tmp.c_str(), "wb");
+  if (f == NULL) {
+    perror(tmp.c_str());
+    return false;
+  }
+  bool ok = writePadded(f, &header, sizeof(header), header.wallsOffset) &&
+            writePadded(f, grid.data(), header.wallsBytes,
+                        distances ? header.distancesOffset : header.wallsOffset + header.wallsBytes) &&
+            (!distances || writePadded(f, distances, header.distancesBytes, 0));
+  ok = fclose(f) == 0 && ok;
+  if (!ok || rename(tmp.c_str(), path) != 0) {
+    perror(path);
+    remove(tmp.c_str());
+    return false;
+  }
+  return true;
+}
+
+bool MazeFile::open(const char* path) {
+  close();
+  int fd = ::open(path, O_RDONLY);
+  if (fd < 0) {
+    perror(path);
+    return false;
+  }
+  struct stat st;
+  if (fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(MazeFileHeader)) {
+    fprintf(stderr, "%s: not a maze file\n", path);
+    ::close(fd);
+    return false;
+  }
+  size = st.st_size;
+  // private and writable: pages are shared with the page cache until the grid changes one
+  map = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+  ::close(fd);
+  if (map == MAP_FAILED) {
+    map = NULL;
+    perror(path);
+    return false;
+  }
+
+  MazeFileHeader header;
+  memcpy(&header, map, sizeof(header));
+  uint64_t stored = header.headerChecksum;
+  header.headerChecksum = 0;
+  const char* problem = NULL;
+  if (memcmp(header.magic, "MAZE", 4) != 0) problem = "not a maze file";
+  else if (header.version != MAZE_FILE_VERSION) problem = "unsupported maze file version";
+  else if (header.byteOrder != 0x0102) problem = "maze file written with another byte order";
+  else if (mazeChecksum(&header, sizeof(header)) != stored) problem = "corrupt maze file header";
+  else if (header.layout > Grid::TILED || header.width > 0x7fffffff || header.height > 0x7fffffff ||
+           header.algorithm[sizeof(header.algorithm) - 1] != '\0')
+    problem = "bad maze file header";
+  else if (header.wallsOffset % MAZE_FILE_ALIGN || header.distancesOffset % MAZE_FILE_ALIGN ||
+           header.wallsBytes != Grid::wordCount(header.width, header.height, (Grid::Layout)header.layout) * 8 ||
+           header.wallsOffset + header.wallsBytes > size ||
+           (header.distancesBytes && (header.distancesBytes != (uint64_t)header.width * header.height * 4 ||
+                                      header.distancesOffset + header.distancesBytes > size)))
+    problem = "truncated maze file";
+  if (problem) {
+    fprintf(stderr, "%s: %s\n", path, problem);
+    close();
+    return false;
+  }
+
+  char* base = (char*)map;
+  g = Grid::wrap(header.width, header.height, (Grid::Layout)header.layout, (uint64_t*)(base + header.wallsOffset));
+  dist = header.distancesBytes ? (const uint32_t*)(base + header.distancesOffset) : NULL;
+  inf.seed = header.seed;
+  inf.algorithm = header.algorithm;
+  inf.diamondX = header.diamondX;
+  inf.diamondZ = header.diamondZ;
+  return true;
+}
+
+bool MazeFile::verify() const {
+  if (map == NULL) return false;
+  const MazeFileHeader* header = (const MazeFileHeader*)map;
+  const char* base = (const char*)map;
+  if (mazeChecksum(base + header->wallsOffset, header->wallsBytes) != header->wallsChecksum) return false;
+  return header->distancesBytes == 0 ||
+         mazeChecksum(base + header->distancesOffset, header->distancesBytes) == header->distancesChecksum;
+}
+
+void MazeFile::close() {
+  g = Grid();
+  dist = NULL;
+  inf = MazeInfo();
+  if (map) munmap(map, size);
+  map = NULL;
+  size = 0;
+}
@@ -0,0 +1,91 @@
+#ifndef MAZE_FILE_H
+#define MAZE_FILE_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string>
+#include "Grid.h"
+
+// Binary maze files (.maze), written once and loaded with mmap.
+//
+// Layout, little endian, every section starting on a 4096 byte boundary so
+// it can be used straight from the mapping:
+//   header          MazeFileHeader below, 128 bytes
+//   walls           the Grid words exactly as Grid stores them in 'layout'
+//   distances       optional, uint32 per cell in row-major order, the
+//                   distance field from the start cell (0,0), see DistanceField.h
+//                   (0xffffffff unreachable)
+//
+// The header carries its own checksum, checked on every open. Each section
+// has one too, which open() leaves alone so a 10000 x 10000 level maps in
+// microseconds; verify() reads everything and checks them.
+//
+//   MazeInfo info;  info.seed = 42;  info.algorithm = "kruskal";
+//   saveMaze("level.maze", grid, info);
+//   MazeFile file;
+//   if (file.open("level.maze")) use(file.grid());
+
+#define MAZE_FILE_VERSION 1
+
+struct MazeInfo {
+  unsigned long long seed;
+  std::string algorithm;  // name in mazeAlgorithms(), at most 31 characters
+  int diamondX, diamondZ; // cell holding the diamond
+  MazeInfo() : seed(0), diamondX(0), diamondZ(0) {}
+};
+
+struct MazeFileHeader {
+  char magic[4];             // "MAZE"
+  uint16_t version;          // MAZE_FILE_VERSION
+  uint16_t byteOrder;        // 0x0102 as written, anything else is a foreign file
+  uint32_t width, height;
+  uint32_t layout;           // Grid::Layout
+  int32_t diamondX, diamondZ;
+  uint32_t reserved;         // 0
+  uint64_t seed;
+  char algorithm[32];        // NUL terminated
+  uint64_t wallsOffset, wallsBytes;
+  uint64_t distancesOffset, distancesBytes;  // both 0 without distances
+  uint64_t wallsChecksum, distancesChecksum;
+  uint64_t headerChecksum;   // of this header with headerChecksum set to 0
+};
+
+// 64-bit checksum of 'size' bytes, 4 lanes of 8 byte words so it runs at memory speed
+uint64_t mazeChecksum(const void* data, size_t size);
+
+// Writes to a temporary file renamed over 'path', so a crash never leaves a
+// half written maze. 'distances' may be NULL. False with a message on failure.
+bool saveMaze(const char* path, const Grid& grid, const MazeInfo& info, const uint32_t* distances = NULL);
+
+// A maze file mapped into memory. The grid reads straight from the mapping;
+// the mapping is private, so changing the grid never touches the file.
+class MazeFile {
+  public:
+    MazeFile() : map(NULL), size(0), dist(NULL) {}
+    ~MazeFile() { close(); }
+
+    // map 'path' and check its header; false with a message if it isn't a usable maze file
+    bool open(const char* path);
+    void close();
+    bool isOpen() const { return map != NULL; }
+
+    // checksum of every section, reads the whole file; edits made through grid() count as damage
+    bool verify() const;
+
+    Grid& grid() { return g; }
+    const Grid& grid() const { return g; }
+    const MazeInfo& info() const { return inf; }
+    const uint32_t* distances() const { return dist; }  // NULL if the file has none
+
+  private:
+    void* map;
+    size_t size;
+    Grid g;
+    MazeInfo inf;
+    const uint32_t* dist;
+
+    MazeFile(const MazeFile&);
+    MazeFile& operator=(const MazeFile&);
+};
+
+#endif
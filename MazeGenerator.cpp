@@ -1,34 +1,36 @@
+#include <algorithm>
+#include <vector>
 #include "MazeGenerator.h"
 
 using namespace std;
 
-Maze::Maze(int dimx, int dimz){
+Maze::Maze(int dimx, int dimz, Grid::Layout layout) : maze(dimx, dimz, layout) {
   gridx = dimx;
   gridz = dimz;
-  // 0:LEFT 1:RIGHT 2:UP 3:DOWN
-  x_move[0] = -1; x_move[1] = 1; x_move[2] = 0; x_move[3] = 0;
-  z_move[0] = 0; z_move[1] = 0; z_move[2] = 1; z_move[3] = -1;
-  for(int i=0; i<150; i++)
-    for(int j=0; j<150; j++)
-      maze.arr[i][j]='-';
+  visited.assign(((size_t)gridx*gridz + 63)/64, 0);
 }
 
 bool Maze::isValid(int xcoord, int zcoord){
-  if(xcoord<0 || xcoord>gridx || zcoord<0 || zcoord>gridz) return false;
-  else if(maze.arr[zcoord][xcoord]!='-') return false; // this cell has already been visited
-  else return true;
+  if(xcoord<0 || xcoord>=gridx || zcoord<0 || zcoord>=gridz) return false;
+  size_t cell = (size_t)zcoord*gridx + xcoord;
+  if(visited[cell/64] >> (cell%64) & 1) return false; // this cell has already been visited
+  return true;
 }
 
-struct Grid Maze::generateMaze(){
-  // figure out a path to the end of the maze
-  int start_x = gridx/2;
-  int start_z = 0;
-  int i,j;
-  for(i=99;i>=75;i--) maze.arr[i][start_x]='U';
-  for(j=start_x;j>=25;j--) maze.arr[75][j]='L';
-  for(i=74;i>=50;i--) maze.arr[i][25]='U';
-  for(j=24;j>=0;j--) maze.arr[50][j]='L';
-  for(i=50;i>=0;i--) maze.arr[i][0]='U';
+const Grid& Maze::generate(const MazeAlgorithm& algorithm){
+  // any registered generator (see MazeAlgorithms.h), they all fill the same grid
+  maze.clear();
+  if(gridx <= 0 || gridz <= 0) return maze;
+  algorithm.generate(maze, rng);
+  fill(visited.begin(), visited.end(), ~(uint64_t)0);  // every cell is part of the maze
   cout<<"maze generated successfully!\n";
   return maze;
 }
+
+const Grid& Maze::generateMaze(){
+  return generate(*findMazeAlgorithm("backtracker"));
+}
+
+const Grid& Maze::generateEller(){
+  return generate(*findMazeAlgorithm("eller"));
+}
@@ -2,18 +2,23 @@
 #include <map>
 #include <stdlib.h>
 #include <iostream>
-
-struct Grid {
-  char arr[150][150];
-};
+#include <vector>
+#include "Grid.h"
+#include "Random.h"
+#include "MazeAlgorithms.h"
 
 class Maze{
 private:
   int gridx, gridz;
-  int x_move[4], z_move[4];
-  struct Grid maze;
+  Grid maze;
+  Random rng;
+  std::vector<uint64_t> visited;  // 1 bit per cell, set once a generator has run
 public:
-  Maze(int , int );
-  struct Grid generateMaze();
+  Maze(int , int , Grid::Layout layout = Grid::ROW_MAJOR);
+  void setSeed(unsigned long long seed) { rng.setSeed(seed); }  // same seed, same maze
+  const Grid& generate(const MazeAlgorithm& algorithm);
+  const Grid& generateMaze();   // backtracker
+  const Grid& generateEller();  // eller
+  const Grid& grid() const { return maze; }
   bool isValid(int , int);
 };
@@ -0,0 +1,134 @@
+#include "Minimap.h"
+#include "RayCast.h"
+
+using namespace std;
+
+namespace {
+
+// colours of fully discovered floor and wall
+const int FLOOR_R = 200, FLOOR_G = 196, FLOOR_B = 180;
+const int WALL_R = 70, WALL_G = 70, WALL_B = 90;
+
+}  // namespace
+
+void Minimap::assign(const OccupancyGrid& g) {
+  walls = &g;
+  w = g.width();
+  h = g.height();
+  rowWords = (w + 63) / 64;
+  seen.assign(rowWords * h, 0);
+  pyramid.clear();
+  for (int k = 1; levelWidth(k - 1) > 1 || levelHeight(k - 1) > 1; k++)
+    pyramid.push_back(vector<Texel>((size_t)levelWidth(k) * levelHeight(k), Texel()));
+  // the whole map goes back to undiscovered
+  dirtyX0 = dirtyZ0 = 0;
+  dirtyX1 = w - 1;
+  dirtyZ1 = h - 1;
+  changes++;
+}
+
+Minimap::Texel Minimap::texel(int level, int x, int z) const {
+  Texel t = {0, 0};
+  if (x >= levelWidth(level) || z >= levelHeight(level)) return t;
+  if (level > 0) return pyramid[level - 1][(size_t)z * levelWidth(level) + x];
+  if (discovered(x, z)) {
+    if (walls->wall(x, z)) t.wall = 255;
+    else t.open = 255;
+  }
+  return t;
+}
+
+bool Minimap::discover(int x, int z) {
+  if ((unsigned)x >= (unsigned)w || (unsigned)z >= (unsigned)h || discovered(x, z)) return false;
+  seen[(size_t)z * rowWords + (x >> 6)] |= (uint64_t)1 << (x & 63);
+  // each level up averages the 2x2 texels below, rounding up so a single
+  // block still shows when zoomed all the way out
+  for (int k = 1; k < levels(); k++) {
+    int px = x >> k, pz = z >> k;
+    unsigned open = 3, wall = 3;
+    for (int dz = 0; dz < 2; dz++)
+      for (int dx = 0; dx < 2; dx++) {
+        Texel c = texel(k - 1, px * 2 + dx, pz * 2 + dz);
+        open += c.open;
+        wall += c.wall;
+      }
+    Texel& t = pyramid[k - 1][(size_t)pz * levelWidth(k) + px];
+    t.open = open / 4;
+    t.wall = wall / 4;
+  }
+  markChanged(x, z);
+  return true;
+}
+
+int Minimap::look(float x, float z, int radius) {
+  if (!walls) return 0;
+  int cx = (int)floorf(x), cz = (int)floorf(z), found = 0;
+  for (int bz = cz - radius; bz <= cz + radius; bz++)
+    for (int bx = cx - radius; bx <= cx + radius; bx++) {
+      if ((bx - cx) * (bx - cx) + (bz - cz) * (bz - cz) > radius * radius) continue;
+      if (walls->wall(bx, bz) || !lineOfSight(*walls, x, z, bx + 0.5f, bz + 0.5f)) continue;
+      // a visible floor block, and whatever surrounds it
+      for (int dz = -1; dz <= 1; dz++)
+        for (int dx = -1; dx <= 1; dx++) found += discover(bx + dx, bz + dz);
+    }
+  return found;
+}
+
+int Minimap::levelFor(int pixels) const {
+  int k = 0;
+  while (k + 1 < levels() && (levelWidth(k) > pixels || levelHeight(k) > pixels)) k++;
+  return k;
+}
+
+void Minimap::render(int level, int x, int z, int width, int height, uint32_t* out) const {
+  const uint32_t floor = pixel(255, 0), wall = pixel(0, 255);
+  for (int tz = z; tz < z + height; tz++) {
+    if (level == 0 && (unsigned)tz < (unsigned)h) {
+      // straight from the bits
+      for (int tx = x; tx < x + width; tx++)
+        *out++ = !discovered(tx, tz) ? 0 : walls->wall(tx, tz) ? wall : floor;
+      continue;
+    }
+    for (int tx = x; tx < x + width; tx++) {
+      Texel t = texel(level, tx, tz);
+      *out++ = t.wall == 0 && t.open == 255 ? floor : t.open == 0 && t.wall == 255 ? wall : pixel(t.open, t.wall);
+    }
+  }
+}
+
+uint32_t Minimap::pixel(unsigned open, unsigned wall) {
+  unsigned sum = open + wall;
+  if (!sum) return 0;
+  // the colour of what was seen, as opaque as the share that was seen;
+  // bytes R, G, B, A in memory on a little endian machine
+  int f = wall * 256 / sum;  // wall share of the colour, one division for all three
+  unsigned r = FLOOR_R + ((WALL_R - FLOOR_R) * f >> 8);
+  unsigned g = FLOOR_G + ((WALL_G - FLOOR_G) * f >> 8);
+  unsigned b = FLOOR_B + ((WALL_B - FLOOR_B) * f >> 8);
+  unsigned a = sum > 255 ? 255 : sum;
+  return r | g << 8 | b << 16 | a << 24;
+}
+
+void Minimap::markChanged(int x, int z) {
+  if (dirtyX0 > dirtyX1) {
+    dirtyX0 = dirtyX1 = x;
+    dirtyZ0 = dirtyZ1 = z;
+  } else {
+    dirtyX0 = min(dirtyX0, x);
+    dirtyX1 = max(dirtyX1, x);
+    dirtyZ0 = min(dirtyZ0, z);
+    dirtyZ1 = max(dirtyZ1, z);
+  }
+  changes++;
+}
+
+bool Minimap::takeChanges(int* x0, int* z0, int* x1, int* z1) {
+  if (dirtyX0 > dirtyX1) return false;
+  *x0 = dirtyX0;
+  *z0 = dirtyZ0;
+  *x1 = dirtyX1;
+  *z1 = dirtyZ1;
+  dirtyX0 = 1;
+  dirtyX1 = 0;
+  return true;
+}
@@ -0,0 +1,80 @@
+#ifndef MINIMAP_H
+#define MINIMAP_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <vector>
+#include "OccupancyGrid.h"
+
+// The 2D map of what the player has seen: which blocks of an OccupancyGrid
+// have been discovered, drawn as pixels for a texture.
+//
+// Above the blocks sits a pyramid like the mip levels of a texture: a texel
+// of level k covers 2^k x 2^k blocks and holds how much of that square is
+// discovered floor and how much discovered wall. Discovering a block updates
+// one texel per level, and a zoomed out map reads the level whose texels are
+// about the size of its pixels, so drawing a 4097 x 4097 maze into 256 pixels
+// reads 256 x 256 texels, not 16 million blocks.
+//
+// The map remembers the blocks that changed since takeChanges() was last
+// called, so the texture is redrawn only where something new was seen.
+//
+//   Minimap map;
+//   map.assign(walls);                       // after generating the maze
+//   map.look(x, z, 4);                       // every time the player moves a block
+//   int level = map.levelFor(256);
+//   map.render(level, 0, 0, map.levelWidth(level), map.levelHeight(level), pixels);
+class Minimap {
+  public:
+    Minimap() : walls(NULL), w(0), h(0), rowWords(0), dirtyX0(1), dirtyZ0(0), dirtyX1(0), dirtyZ1(0), changes(0) {}
+
+    // forget everything discovered, for the map 'walls' (kept by reference)
+    void assign(const OccupancyGrid& walls);
+
+    int width() const { return w; }
+    int height() const { return h; }
+
+    bool discovered(int x, int z) const {
+      if ((unsigned)x >= (unsigned)w || (unsigned)z >= (unsigned)h) return false;
+      return seen[(size_t)z * rowWords + (x >> 6)] >> (x & 63) & 1;
+    }
+    // false if (x,z) was already discovered or is outside the map
+    bool discover(int x, int z);
+    // discover the open blocks within 'radius' blocks of (x,z) that have a
+    // clear line to it, and the walls around them; in block coordinates,
+    // block (x,z) spans [x, x + 1) x [z, z + 1). Returns the blocks discovered
+    int look(float x, float z, int radius);
+
+    // level 0 is the blocks; the last level is a single texel
+    int levels() const { return (int)pyramid.size() + 1; }
+    int levelWidth(int level) const { return (w + (1 << level) - 1) >> level; }
+    int levelHeight(int level) const { return (h + (1 << level) - 1) >> level; }
+    // the first level that fits in 'pixels' along both sides
+    int levelFor(int pixels) const;
+
+    // RGBA8 pixels of texels (x,z) .. (x + width - 1, z + height - 1) of a
+    // level, rows of 'width' pixels; undiscovered ground is transparent
+    void render(int level, int x, int z, int width, int height, uint32_t* out) const;
+
+    // the blocks that changed since the last call, false if none did
+    bool takeChanges(int* x0, int* z0, int* x1, int* z1);
+    // bumped on every change, including assign()
+    unsigned version() const { return changes; }
+
+  private:
+    struct Texel { uint8_t open, wall; };  // discovered share of the square, 0 .. 255
+
+    const OccupancyGrid* walls;
+    int w, h;
+    size_t rowWords;
+    std::vector<uint64_t> seen;                  // a bit per block, rows of rowWords words
+    std::vector<std::vector<Texel> > pyramid;    // levels 1 and up
+    int dirtyX0, dirtyZ0, dirtyX1, dirtyZ1;      // empty when x0 > x1
+    unsigned changes;
+
+    Texel texel(int level, int x, int z) const;
+    static uint32_t pixel(unsigned open, unsigned wall);
+    void markChanged(int x, int z);
+};
+
+#endif
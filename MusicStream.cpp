@@ -0,0 +1,105 @@
+#include "MusicStream.h"
+#include <chrono>
+
+using namespace std;
+
+bool MusicStream::open(const char* path, bool loopTrack) {
+  stop();
+  if (!wav.open(path)) return false;
+  loop = loopTrack;
+  if (wav.channels() == 1) format = wav.bitsPerSample() == 8 ? AL_FORMAT_MONO8 : AL_FORMAT_MONO16;
+  else format = wav.bitsPerSample() == 8 ? AL_FORMAT_STEREO8 : AL_FORMAT_STEREO16;
+  chunk.resize(CHUNK_FRAMES * wav.frameBytes());
+
+  alGetError();
+  alGenSources(1, &source);
+  if (alGetError() != AL_NO_ERROR) {
+    fprintf(stderr, "%s: no OpenAL source to play it on\n", path);
+    source = 0;
+    wav.close();
+    return false;
+  }
+  alGenBuffers(BUFFERS, buffers);
+  if (alGetError() != AL_NO_ERROR) {
+    fprintf(stderr, "%s: no OpenAL buffers to stream it through\n", path);
+    alDeleteSources(1, &source);
+    source = 0;
+    wav.close();
+    return false;
+  }
+  // the looping is done here, OpenAL would loop the queued buffers only
+  alSourcei(source, AL_LOOPING, AL_FALSE);
+  int queued = 0;
+  while (queued < BUFFERS && fill(buffers[queued])) queued++;
+  alSourceQueueBuffers(source, queued, buffers);
+  finished = queued == 0;
+  return true;
+}
+
+bool MusicStream::fill(ALuint buffer) {
+  size_t got = wav.read(&chunk[0], CHUNK_FRAMES);
+  // a looping track carries on from the start in the same buffer, so there
+  // is no gap at the seam; nothing read right after a rewind is a read
+  // error or a cut-short file, and the track ends there instead
+  while (loop && got < CHUNK_FRAMES && wav.frames() > 0 && wav.rewind()) {
+    size_t more = wav.read(&chunk[got * wav.frameBytes()], CHUNK_FRAMES - got);
+    if (!more) break;
+    got += more;
+  }
+  if (!got) return false;
+  alBufferData(buffer, format, &chunk[0], (ALsizei)(got * wav.frameBytes()), wav.sampleRate());
+  return true;
+}
+
+void MusicStream::play(bool background) {
+  if (!source || started) return;
+  alSourcePlay(source);
+  started = true;
+  if (!background) return;
+  running = true;
+  thread = std::thread(&MusicStream::run, this);
+}
+
+bool MusicStream::pump() {
+  if (!source || finished) return false;
+  ALint processed = 0;
+  alGetSourcei(source, AL_BUFFERS_PROCESSED, &processed);
+  while (processed-- > 0) {
+    ALuint buffer;
+    alSourceUnqueueBuffers(source, 1, &buffer);
+    if (fill(buffer)) alSourceQueueBuffers(source, 1, &buffer);
+  }
+  ALint queued = 0, state = AL_STOPPED;
+  alGetSourcei(source, AL_BUFFERS_QUEUED, &queued);
+  alGetSourcei(source, AL_SOURCE_STATE, &state);
+  if (!queued) {
+    finished = true;
+    return false;
+  }
+  // the thread fell behind and the source played everything it had
+  if (started && state != AL_PLAYING) alSourcePlay(source);
+  return true;
+}
+
+void MusicStream::run() {
+  // a few looks per buffer, so a refill is never late by more than a part of one
+  long sleepMs = 1000L * CHUNK_FRAMES / wav.sampleRate() / 4;
+  if (sleepMs < 1) sleepMs = 1;
+  while (running && pump())
+    this_thread::sleep_for(chrono::milliseconds(sleepMs));
+}
+
+void MusicStream::stop() {
+  running = false;
+  if (thread.joinable()) thread.join();
+  if (source) {
+    alSourceStop(source);
+    alSourcei(source, AL_BUFFER, 0);  // unqueues everything
+    alDeleteSources(1, &source);
+    alDeleteBuffers(BUFFERS, buffers);
+    source = 0;
+  }
+  wav.close();
+  started = false;
+  finished = true;
+}
@@ -0,0 +1,67 @@
+#ifndef MUSIC_STREAM_H
+#define MUSIC_STREAM_H
+
+#include <atomic>
+#include <thread>
+#include <vector>
+#include <AL/al.h>
+#include "WavStream.h"
+
+// Background music streamed from a .wav file through an OpenAL source.
+//
+// Instead of loading the whole track into one buffer, the source plays a
+// queue of BUFFERS small buffers of CHUNK_FRAMES frames each. A background
+// thread wakes a few times per buffer, takes back the buffers OpenAL has
+// finished with (alSourceUnqueueBuffers), refills them with the next frames
+// from the file and queues them again (alSourceQueueBuffers). Memory stays
+// at BUFFERS chunks however long the track is, and playing starts as soon as
+// the first chunks are read, a few milliseconds.
+//
+// Needs a current OpenAL context, any device will do: a sound card, OpenAL
+// Soft's null device, or a loopback device rendered by hand. With the
+// loopback device, play(false) and call pump() after each render instead of
+// running the thread, so the stream keeps pace with the rendering.
+//
+//   MusicStream music;
+//   if (music.open("./sounds/test.wav", true)) music.play();
+//   ...
+//   music.stop();   // before the context goes away
+class MusicStream {
+  public:
+    enum { BUFFERS = 4, CHUNK_FRAMES = 4096 };
+
+    MusicStream() : loop(false), source(0), format(0), started(false), running(false), finished(false) {}
+    ~MusicStream() { stop(); }
+
+    // open the track and queue the first chunks; false with a message on failure
+    bool open(const char* path, bool loop);
+    // start playing, refilling from a thread unless 'background' is false
+    void play(bool background = true);
+    // stop playing and free the source and buffers
+    void stop();
+
+    // refill and requeue the buffers that have been played, restart the
+    // source if it ran dry; false once a track that doesn't loop has ended
+    bool pump();
+
+    ALuint alSource() const { return source; }
+    bool done() const { return finished; }
+
+  private:
+    WavStream wav;
+    bool loop;
+    ALuint source, buffers[BUFFERS];
+    ALenum format;
+    std::vector<char> chunk;
+    bool started;
+    std::atomic<bool> running, finished;
+    std::thread thread;
+
+    bool fill(ALuint buffer);
+    void run();
+
+    MusicStream(const MusicStream&);
+    MusicStream& operator=(const MusicStream&);
+};
+
+#endif
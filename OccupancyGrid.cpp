@@ -0,0 +1,83 @@
+#include "OccupancyGrid.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define OCCUPANCY_AVX2 1
+#endif
+
+using namespace std;
+
+void OccupancyGrid::resize(int width, int height) {
+  w = width;
+  h = height;
+  tilesX = (w + 7) / 8 + 2;
+  unsigned tilesZ = (h + 7) / 8 + 2;
+  spanX = tilesX * 8;
+  spanZ = tilesZ * 8;
+  tiles.assign((size_t)tilesX * tilesZ, ~(uint64_t)0);
+}
+
+unsigned OccupancyGrid::window4(int x, int z) const {
+  unsigned ux = x + 8, uz = z + 8;
+  if (ux > spanX - 4 || uz > spanZ - 4 || (ux >> 3) + 1 >= tilesX) {
+    // far outside the map, or too close to the far side of the ring for two tiles
+    unsigned out = 0;
+    for (int dz = 0; dz < 4; dz++)
+      for (int dx = 0; dx < 4; dx++) out |= (unsigned)wall(x + dx, z + dz) << (dz * 4 + dx);
+    return out;
+  }
+  // each row is 16 bits from the tile holding x and the one to its right,
+  // moving down to the next row of tiles when the window crosses it
+  const uint64_t* t = &tiles[(uz >> 3) * tilesX + (ux >> 3)];
+  unsigned sx = ux & 7, r = uz & 7, out = 0;
+  for (int dz = 0; dz < 4; dz++, r++) {
+    if (r == 8) {
+      t += tilesX;
+      r = 0;
+    }
+    unsigned row = (unsigned)(t[0] >> (r * 8) & 0xff) | (unsigned)(t[1] >> (r * 8) & 0xff) << 8;
+    out |= (row >> sx & 15) << (dz * 4);
+  }
+  return out;
+}
+
+#ifdef OCCUPANCY_AVX2
+// the tiles read as 32-bit words: block bit b of tile t is bit b & 31 of word t * 2 + b / 32
+__attribute__((target("avx2")))
+static size_t wallsAVX2(const uint64_t* tiles, unsigned tilesX, unsigned spanX, unsigned spanZ,
+                        const int* x, const int* z, size_t n, unsigned char* out) {
+  const __m256i eight = _mm256_set1_epi32(8), seven = _mm256_set1_epi32(7), one = _mm256_set1_epi32(1);
+  const __m256i lastX = _mm256_set1_epi32(spanX - 1), lastZ = _mm256_set1_epi32(spanZ - 1);
+  const __m256i stride = _mm256_set1_epi32(tilesX);
+  size_t i = 0;
+  for (; i + 8 <= n; i += 8) {
+    __m256i ux = _mm256_add_epi32(_mm256_loadu_si256((const __m256i*)(x + i)), eight);
+    __m256i uz = _mm256_add_epi32(_mm256_loadu_si256((const __m256i*)(z + i)), eight);
+    // unsigned compares, negative coordinates wrap around and land outside too
+    __m256i inside = _mm256_and_si256(_mm256_cmpeq_epi32(_mm256_min_epu32(ux, lastX), ux),
+                                      _mm256_cmpeq_epi32(_mm256_min_epu32(uz, lastZ), uz));
+    __m256i tile = _mm256_add_epi32(_mm256_mullo_epi32(_mm256_srli_epi32(uz, 3), stride), _mm256_srli_epi32(ux, 3));
+    __m256i bit = _mm256_or_si256(_mm256_slli_epi32(_mm256_and_si256(uz, seven), 3), _mm256_and_si256(ux, seven));
+    __m256i word = _mm256_add_epi32(_mm256_slli_epi32(tile, 1), _mm256_srli_epi32(bit, 5));
+    // lanes outside read word 0 and are forced to wall below
+    word = _mm256_and_si256(word, inside);
+    __m256i v = _mm256_i32gather_epi32((const int*)tiles, word, 4);
+    v = _mm256_and_si256(_mm256_srlv_epi32(v, _mm256_and_si256(bit, _mm256_set1_epi32(31))), one);
+    v = _mm256_or_si256(v, _mm256_andnot_si256(inside, one));
+    __m128i p = _mm_packs_epi32(_mm256_castsi256_si128(v), _mm256_extracti128_si256(v, 1));
+    _mm_storel_epi64((__m128i*)(out + i), _mm_packus_epi16(p, p));
+  }
+  return i;
+}
+#endif
+
+void OccupancyGrid::walls(const int* x, const int* z, size_t n, unsigned char* out) const {
+  size_t i = 0;
+#ifdef OCCUPANCY_AVX2
+  static const bool avx2 = __builtin_cpu_supports("avx2");
+  // the gather indexes 32-bit words with 32-bit lanes
+  if (avx2 && tiles.size() < 0x40000000)
+    i = wallsAVX2(&tiles[0], tilesX, spanX, spanZ, x, z, n, out);
+#endif
+  for (; i < n; i++) out[i] = wall(x[i], z[i]);
+}
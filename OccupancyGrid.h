@@ -0,0 +1,81 @@
+#ifndef OCCUPANCY_GRID_H
+#define OCCUPANCY_GRID_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <vector>
+
+// Which blocks of a map are walls, one bit per block, for collision.
+//
+// Each 64-bit word holds an 8x8 tile of blocks, bit (z & 7) * 8 + (x & 7),
+// so the blocks around a position are nearly always in one word and at most
+// in four: window4() and window3() fetch a whole neighbourhood with a couple
+// of loads. A 4097 x 4097 map takes 2 MB where a byte per block takes 16 MB
+// and an int per block 64 MB.
+//
+// A ring of one tile of walls surrounds the map, so lookups near the edge
+// need no bounds checks; anything further out is a wall as well.
+//
+//   OccupancyGrid walls;
+//   walls.assign(maze);                  // any map with width(), height(), wall(x, z)
+//   if (walls.wall(x, z)) ...
+//   unsigned around = walls.window3(x, z);
+class OccupancyGrid {
+  public:
+    OccupancyGrid() : w(0), h(0), tilesX(0), spanX(0), spanZ(0) {}
+    OccupancyGrid(int width, int height) { resize(width, height); }
+
+    // width x height blocks, all walls
+    void resize(int width, int height);
+    template <class Map> void assign(const Map& map) {
+      resize(map.width(), map.height());
+      for (int x = 0; x < w; x++)
+        for (int z = 0; z < h; z++)
+          if (!map.wall(x, z)) set(x, z, false);
+    }
+
+    int width() const { return w; }
+    int height() const { return h; }
+    size_t bytes() const { return tiles.size() * sizeof(uint64_t); }
+
+    // the tiles, ring included: block (x,z) is bit ((z + 8) & 7) * 8 + ((x + 8) & 7)
+    // of word ((z + 8) / 8) * tileStride() + (x + 8) / 8, for vector code
+    const uint64_t* data() const { return tiles.data(); }
+    unsigned tileStride() const { return tilesX; }
+    // blocks covered by data() along x and z, ring included
+    unsigned spanWidth() const { return spanX; }
+    unsigned spanHeight() const { return spanZ; }
+
+    bool wall(int x, int z) const {
+      unsigned ux = x + 8, uz = z + 8;
+      if (ux >= spanX || uz >= spanZ) return true;
+      return tiles[(uz >> 3) * tilesX + (ux >> 3)] >> ((uz & 7) * 8 + (ux & 7)) & 1;
+    }
+    // (x,z) must be inside the map
+    void set(int x, int z, bool wall) {
+      unsigned ux = x + 8, uz = z + 8;
+      uint64_t bit = (uint64_t)1 << ((uz & 7) * 8 + (ux & 7));
+      uint64_t& t = tiles[(uz >> 3) * tilesX + (ux >> 3)];
+      t = wall ? t | bit : t & ~bit;
+    }
+
+    // walls among the 4x4 blocks from (x,z) to (x+3,z+3), bit dz * 4 + dx
+    unsigned window4(int x, int z) const;
+    // walls among the 3x3 blocks around (x,z), bit (dz + 1) * 3 + dx + 1
+    unsigned window3(int x, int z) const {
+      unsigned b = window4(x - 1, z - 1);
+      return (b & 7) | (b >> 1 & 0x38) | (b >> 2 & 0x1c0);
+    }
+
+    // out[i] = wall(x[i], z[i]) for n positions, 8 at a time with AVX2 gathers
+    // where the CPU has them
+    void walls(const int* x, const int* z, size_t n, unsigned char* out) const;
+
+  private:
+    int w, h;
+    unsigned tilesX;       // words per row of tiles, ring included
+    unsigned spanX, spanZ; // blocks covered by the words, ring included
+    std::vector<uint64_t> tiles;
+};
+
+#endif
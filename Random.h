@@ -0,0 +1,54 @@
+#ifndef RANDOM_H
+#define RANDOM_H
+
+#include <stdint.h>
+
+// xoshiro256** (Blackman & Vigna), seeded through splitmix64 so any 64-bit
+// seed, 0 included, gives a good state. Each generator is its own instance:
+// the same seed always produces the same sequence, whatever else calls rand().
+class Random {
+  public:
+    explicit Random(uint64_t seed = 0) { setSeed(seed); }
+
+    void setSeed(uint64_t seed) {
+      for (int i = 0; i < 4; i++) {
+        seed += 0x9e3779b97f4a7c15ULL;
+        uint64_t z = seed;
+        z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+        z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+        s[i] = z ^ (z >> 31);
+      }
+    }
+
+    uint64_t next() {
+      uint64_t result = rotl(s[1] * 5, 7) * 9;
+      uint64_t t = s[1] << 17;
+      s[2] ^= s[0];
+      s[3] ^= s[1];
+      s[1] ^= s[2];
+      s[0] ^= s[3];
+      s[2] ^= t;
+      s[3] = rotl(s[3], 45);
+      return result;
+    }
+
+    // uniform in [0, n), n > 0, by multiply-shift (Lemire) instead of a division
+    uint32_t below(uint32_t n) {
+      return (uint32_t)(((next() >> 32) * (uint64_t)n) >> 32);
+    }
+
+    // one set bit of 'mask' chosen uniformly, 0 if mask is 0; one draw, no retries
+    unsigned pickBit(unsigned mask) {
+      if (mask == 0) return 0;
+      for (uint32_t k = below(__builtin_popcount(mask)); k > 0; k--)
+        mask &= mask - 1;  // drop the lowest set bit
+      return mask & (0u - mask);
+    }
+
+  private:
+    uint64_t s[4];
+
+    static uint64_t rotl(uint64_t x, int k) { return (x << k) | (x >> (64 - k)); }
+};
+
+#endif
@@ -0,0 +1,147 @@
+#include "RayCast.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define RAYCAST_AVX2 1
+#endif
+
+using namespace std;
+
+namespace {
+
+struct OccupancyWalls {
+  const OccupancyGrid& walls;
+  bool operator()(int x, int z) const { return walls.wall(x, z); }
+};
+
+bool hasAVX2(const OccupancyGrid& walls) {
+#ifdef RAYCAST_AVX2
+  static const bool avx2 = __builtin_cpu_supports("avx2");
+  // the gathers index 32-bit words with 32-bit lanes
+  return avx2 && walls.bytes() / 4 < 0x80000000u;
+#else
+  (void)walls;
+  return false;
+#endif
+}
+
+#ifdef RAYCAST_AVX2
+static_assert(sizeof(Ray) == 5 * sizeof(float), "packetAVX2 gathers the rays as 5 floats each");
+
+// Amanatides & Woo on 8 lanes, the same steps castRay() takes. Block
+// coordinates are kept shifted by 8 like OccupancyGrid::data() wants them
+__attribute__((target("avx2")))
+unsigned packetAVX2(const OccupancyGrid& walls, const Ray* rays, RayHit* hits) {
+  // the rays are 5 floats each, gather them into one vector per field
+  const __m256i field = _mm256_setr_epi32(0, 5, 10, 15, 20, 25, 30, 35);
+  const float* base = &rays[0].x;
+  const __m256 ox = _mm256_i32gather_ps(base, field, 4), oz = _mm256_i32gather_ps(base + 1, field, 4);
+  const __m256 dx = _mm256_i32gather_ps(base + 2, field, 4), dz = _mm256_i32gather_ps(base + 3, field, 4);
+  const __m256 maxT = _mm256_i32gather_ps(base + 4, field, 4);
+
+  const __m256 zero = _mm256_setzero_ps(), one = _mm256_set1_ps(1), sign = _mm256_set1_ps(-0.0f);
+  const __m256i eight = _mm256_set1_epi32(8), ones = _mm256_set1_epi32(1);
+  const __m256 fx = _mm256_floor_ps(ox), fz = _mm256_floor_ps(oz);
+  __m256i x = _mm256_add_epi32(_mm256_cvtps_epi32(fx), eight);
+  __m256i z = _mm256_add_epi32(_mm256_cvtps_epi32(fz), eight);
+  const __m256 posX = _mm256_cmp_ps(dx, zero, _CMP_GT_OQ), negX = _mm256_cmp_ps(dx, zero, _CMP_LT_OQ);
+  const __m256 posZ = _mm256_cmp_ps(dz, zero, _CMP_GT_OQ), negZ = _mm256_cmp_ps(dz, zero, _CMP_LT_OQ);
+  const __m256 movesX = _mm256_or_ps(posX, negX), movesZ = _mm256_or_ps(posZ, negZ);
+  // +1, -1 or 0
+  const __m256i stepX = _mm256_or_si256(_mm256_and_si256(_mm256_castps_si256(posX), ones), _mm256_castps_si256(negX));
+  const __m256i stepZ = _mm256_or_si256(_mm256_and_si256(_mm256_castps_si256(posZ), ones), _mm256_castps_si256(negZ));
+  // 1 / |d|, 0 for an axis the ray doesn't move along
+  const __m256 deltaX = _mm256_and_ps(_mm256_div_ps(one, _mm256_andnot_ps(sign, dx)), movesX);
+  const __m256 deltaZ = _mm256_and_ps(_mm256_div_ps(one, _mm256_andnot_ps(sign, dz)), movesZ);
+  // t of the first border crossed: from the origin to x + 1 going +x, to x going -x
+  const __m256 toX = _mm256_blendv_ps(_mm256_sub_ps(ox, fx), _mm256_sub_ps(_mm256_add_ps(fx, one), ox), posX);
+  const __m256 toZ = _mm256_blendv_ps(_mm256_sub_ps(oz, fz), _mm256_sub_ps(_mm256_add_ps(fz, one), oz), posZ);
+  __m256 nextX = _mm256_blendv_ps(_mm256_set1_ps(INFINITY), _mm256_mul_ps(toX, deltaX), movesX);
+  __m256 nextZ = _mm256_blendv_ps(_mm256_set1_ps(INFINITY), _mm256_mul_ps(toZ, deltaZ), movesZ);
+
+  const __m256i seven = _mm256_set1_epi32(7), low5 = _mm256_set1_epi32(31);
+  const __m256i lastX = _mm256_set1_epi32(walls.spanWidth() - 1), lastZ = _mm256_set1_epi32(walls.spanHeight() - 1);
+  const __m256i stride = _mm256_set1_epi32(walls.tileStride());
+  const int* words = (const int*)walls.data();
+
+  // a ray with no direction never crosses a border, it hits nothing
+  __m256i active = _mm256_castps_si256(_mm256_or_ps(movesX, movesZ)), hit = _mm256_setzero_si256();
+  __m256i hitX = _mm256_setzero_si256(), hitZ = hitX, hitAlongX = hitX;
+  __m256 hitT = zero;
+  for (;;) {
+    const __m256 alongXf = _mm256_cmp_ps(nextX, nextZ, _CMP_LT_OQ);
+    const __m256i alongX = _mm256_castps_si256(alongXf);
+    const __m256 t = _mm256_blendv_ps(nextZ, nextX, alongXf);
+    active = _mm256_andnot_si256(_mm256_castps_si256(_mm256_cmp_ps(t, maxT, _CMP_GT_OQ)), active);
+
+    // the block the ray enters, a wall if outside the grid (unsigned compare)
+    const __m256i nx = _mm256_add_epi32(x, _mm256_and_si256(alongX, stepX));
+    const __m256i nz = _mm256_add_epi32(z, _mm256_andnot_si256(alongX, stepZ));
+    const __m256i inside = _mm256_and_si256(_mm256_cmpeq_epi32(_mm256_min_epu32(nx, lastX), nx),
+                                            _mm256_cmpeq_epi32(_mm256_min_epu32(nz, lastZ), nz));
+    const __m256i tile = _mm256_add_epi32(_mm256_mullo_epi32(_mm256_srli_epi32(nz, 3), stride), _mm256_srli_epi32(nx, 3));
+    const __m256i bit = _mm256_or_si256(_mm256_slli_epi32(_mm256_and_si256(nz, seven), 3), _mm256_and_si256(nx, seven));
+    const __m256i word = _mm256_and_si256(_mm256_add_epi32(_mm256_slli_epi32(tile, 1), _mm256_srli_epi32(bit, 5)), inside);
+    const __m256i v = _mm256_mask_i32gather_epi32(_mm256_setzero_si256(), words, word, active, 4);
+    const __m256i wall = _mm256_or_si256(_mm256_and_si256(_mm256_srlv_epi32(v, _mm256_and_si256(bit, low5)), ones),
+                                         _mm256_andnot_si256(inside, ones));
+
+    const __m256i now = _mm256_and_si256(_mm256_cmpeq_epi32(wall, ones), active);
+    hitT = _mm256_blendv_ps(hitT, t, _mm256_castsi256_ps(now));
+    hitX = _mm256_blendv_epi8(hitX, x, now);
+    hitZ = _mm256_blendv_epi8(hitZ, z, now);
+    hitAlongX = _mm256_blendv_epi8(hitAlongX, alongX, now);
+    hit = _mm256_or_si256(hit, now);
+    active = _mm256_andnot_si256(now, active);
+    if (_mm256_testz_si256(active, active)) break;
+
+    // finished lanes keep stepping, harmlessly
+    x = nx;
+    z = nz;
+    nextX = _mm256_add_ps(nextX, _mm256_and_ps(alongXf, deltaX));
+    nextZ = _mm256_add_ps(nextZ, _mm256_andnot_ps(alongXf, deltaZ));
+  }
+
+  unsigned mask = _mm256_movemask_ps(_mm256_castsi256_ps(hit));
+  alignas(32) float t[8];
+  alignas(32) int hx[8], hz[8], along[8];
+  _mm256_store_ps(t, hitT);
+  _mm256_store_si256((__m256i*)hx, hitX);
+  _mm256_store_si256((__m256i*)hz, hitZ);
+  _mm256_store_si256((__m256i*)along, hitAlongX);
+  for (unsigned m = mask; m; m &= m - 1) {
+    int i = __builtin_ctz(m);
+    hits[i].t = t[i];
+    hits[i].x = hx[i] - 8;
+    hits[i].z = hz[i] - 8;
+    hits[i].side = along[i] ? (rays[i].dx > 0 ? Grid::EAST : Grid::WEST) : (rays[i].dz > 0 ? Grid::SOUTH : Grid::NORTH);
+  }
+  return mask;
+}
+#endif
+
+}  // namespace
+
+bool castRay(const OccupancyGrid& walls, const Ray& ray, RayHit* hit) {
+  OccupancyWalls isWall = {walls};
+  return castRay(blockRays(isWall), ray, hit);
+}
+
+unsigned castPacket(const OccupancyGrid& walls, const Ray* rays, RayHit* hits) {
+#ifdef RAYCAST_AVX2
+  if (hasAVX2(walls)) return packetAVX2(walls, rays, hits);
+#endif
+  unsigned mask = 0;
+  for (int i = 0; i < 8; i++) mask |= (unsigned)castRay(walls, rays[i], hits + i) << i;
+  return mask;
+}
+
+void castRays(const OccupancyGrid& walls, const Ray* rays, size_t n, RayHit* hits, unsigned char* hit) {
+  size_t i = 0;
+  if (hasAVX2(walls))
+    for (; i + 8 <= n; i += 8) {
+      unsigned mask = castPacket(walls, rays + i, hits + i);
+      for (int k = 0; k < 8; k++) hit[i + k] = mask >> k & 1;
+    }
+  for (; i < n; i++) hit[i] = castRay(walls, rays[i], hits + i);
+}
@@ -0,0 +1,124 @@
+#ifndef RAY_CAST_H
+#define RAY_CAST_H
+
+#include <math.h>
+#include <stddef.h>
+#include "Grid.h"
+#include "OccupancyGrid.h"
+
+// Rays through a maze, cell by cell (Amanatides & Woo): line of sight,
+// picking the wall under the cursor, occlusion between a sound and the
+// listener. The ray visits exactly the cells it passes and stops at the
+// first wall, so a short ray costs a few steps however large the maze is.
+//
+// Positions are in cells, cell (x,z) spans [x, x + 1) x [z, z + 1). The maze
+// is any map with
+//   bool blocked(int x, int z, int d) const   // leaving (x,z) towards Grid::Direction d hits a wall
+// blockRays() wraps an isWall(x, z) test of a block map (maze[][],
+// OccupancyGrid, the chunked world), GridRays a Grid, where walls are the
+// edges between cells.
+//
+//   Ray ray(x, z, dirX, dirZ, 20);
+//   RayHit hit;
+//   if (castRay(blockRays(isWall), ray, &hit)) ...  // hit.x, hit.z, hit.side
+//
+// castRays() traces a batch; against an OccupancyGrid it runs 8 rays at a
+// time in vector registers. A packet takes as many steps as its longest ray,
+// so it pays off when neighbouring rays travel alike, as in a view fan from
+// one point (about 1.5x in BM_rayCast); for rays scattered over the maze
+// castRay() is as fast.
+
+struct Ray {
+  float x, z;    // origin
+  float dx, dz;  // direction, need not be normalized
+  float maxT;    // the ray ends at origin + maxT * direction
+  Ray() {}
+  Ray(float x, float z, float dx, float dz, float maxT) : x(x), z(z), dx(dx), dz(dz), maxT(maxT) {}
+};
+
+struct RayHit {
+  float t;       // the hit is at origin + t * direction
+  int x, z;      // last open cell before the wall
+  int side;      // Grid::Direction of the wall from (x,z)
+};
+
+// block maps: a block is a cell, walls are whole cells
+template <class IsWall> struct BlockRays {
+  IsWall isWall;
+  explicit BlockRays(IsWall isWall) : isWall(isWall) {}
+  bool blocked(int x, int z, int d) const { return isWall(x + Grid::dx(d), z + Grid::dz(d)); }
+};
+template <class IsWall> BlockRays<IsWall> blockRays(IsWall isWall) { return BlockRays<IsWall>(isWall); }
+
+// Grid: a wall is a closed edge, and so is the outside
+struct GridRays {
+  const Grid& grid;
+  explicit GridRays(const Grid& grid) : grid(grid) {}
+  bool blocked(int x, int z, int d) const { return !grid.passage(x, z, d); }
+};
+
+namespace raycast {
+
+// the stepping state of one ray
+struct Walk {
+  int x, z, stepX, stepZ, sideX, sideZ;
+  float nextX, nextZ;    // t where the ray crosses the next x / z cell border
+  float deltaX, deltaZ;  // t from one border to the next
+};
+
+inline void start(const Ray& r, Walk* w) {
+  w->x = (int)floorf(r.x);
+  w->z = (int)floorf(r.z);
+  if (r.dx > 0) { w->stepX = 1; w->sideX = Grid::EAST; w->deltaX = 1 / r.dx; w->nextX = (w->x + 1 - r.x) * w->deltaX; }
+  else if (r.dx < 0) { w->stepX = -1; w->sideX = Grid::WEST; w->deltaX = -1 / r.dx; w->nextX = (r.x - w->x) * w->deltaX; }
+  else { w->stepX = 0; w->sideX = Grid::EAST; w->deltaX = 0; w->nextX = INFINITY; }
+  if (r.dz > 0) { w->stepZ = 1; w->sideZ = Grid::SOUTH; w->deltaZ = 1 / r.dz; w->nextZ = (w->z + 1 - r.z) * w->deltaZ; }
+  else if (r.dz < 0) { w->stepZ = -1; w->sideZ = Grid::NORTH; w->deltaZ = -1 / r.dz; w->nextZ = (r.z - w->z) * w->deltaZ; }
+  else { w->stepZ = 0; w->sideZ = Grid::SOUTH; w->deltaZ = 0; w->nextZ = INFINITY; }
+}
+
+}  // namespace raycast
+
+// the first wall along the ray, false if it reaches maxT first or has no
+// direction (it would never cross a border, nor reach an infinite maxT)
+template <class Map> bool castRay(const Map& map, const Ray& ray, RayHit* hit) {
+  if (ray.dx == 0 && ray.dz == 0) return false;
+  raycast::Walk w;
+  raycast::start(ray, &w);
+  for (;;) {
+    bool alongX = w.nextX < w.nextZ;
+    float t = alongX ? w.nextX : w.nextZ;
+    if (t > ray.maxT) return false;
+    int side = alongX ? w.sideX : w.sideZ;
+    if (map.blocked(w.x, w.z, side)) {
+      hit->t = t;
+      hit->x = w.x;
+      hit->z = w.z;
+      hit->side = side;
+      return true;
+    }
+    if (alongX) { w.x += w.stepX; w.nextX += w.deltaX; }
+    else { w.z += w.stepZ; w.nextZ += w.deltaZ; }
+  }
+}
+
+// can (ax,az) see (bx,bz)
+template <class Map> bool lineOfSight(const Map& map, float ax, float az, float bx, float bz) {
+  RayHit hit;
+  return !castRay(map, Ray(ax, az, bx - ax, bz - az, 1), &hit);
+}
+
+// any number of rays; hit[i] is 1 if ray i hit a wall
+template <class Map> void castRays(const Map& map, const Ray* rays, size_t n, RayHit* hits, unsigned char* hit) {
+  for (size_t i = 0; i < n; i++) hit[i] = castRay(map, rays[i], hits + i);
+}
+
+// The same against an OccupancyGrid, where the walls are bits a vector can
+// fetch: castPacket() traces 8 rays side by side in AVX2 registers, every
+// step of all 8 in one go, and castRays() feeds it 8 rays at a time. Without
+// AVX2 both fall back to castRay().
+bool castRay(const OccupancyGrid& walls, const Ray& ray, RayHit* hit);
+unsigned castPacket(const OccupancyGrid& walls, const Ray* rays, RayHit* hits);  // bit i set if ray i hit
+void castRays(const OccupancyGrid& walls, const Ray* rays, size_t n, RayHit* hits, unsigned char* hit);
+
+#endif
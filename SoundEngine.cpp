@@ -0,0 +1,175 @@
+#include "SoundEngine.h"
+#include <stdio.h>
+#include <chrono>
+#include "WavStream.h"
+
+using namespace std;
+
+int SoundEngine::load(const char* path) {
+  WavStream wav;
+  if (!wav.open(path)) return -1;
+  vector<char> samples(wav.frames() * wav.frameBytes());
+  size_t got = samples.empty() ? 0 : wav.read(&samples[0], wav.frames());
+  ALenum format;
+  if (wav.channels() == 1) format = wav.bitsPerSample() == 8 ? AL_FORMAT_MONO8 : AL_FORMAT_MONO16;
+  else format = wav.bitsPerSample() == 8 ? AL_FORMAT_STEREO8 : AL_FORMAT_STEREO16;
+  if (wav.channels() != 1)
+    fprintf(stderr, "%s: stereo sounds play without a position\n", path);
+
+  alGetError();
+  ALuint buffer;
+  alGenBuffers(1, &buffer);
+  alBufferData(buffer, format, samples.empty() ? NULL : &samples[0], (ALsizei)(got * wav.frameBytes()), wav.sampleRate());
+  if (alGetError() != AL_NO_ERROR) {
+    fprintf(stderr, "%s: OpenAL would not take the sound\n", path);
+    alDeleteBuffers(1, &buffer);
+    return -1;
+  }
+  buffers.push_back(buffer);
+  return (int)buffers.size() - 1;
+}
+
+bool SoundEngine::start(bool background, float distance) {
+  if (started) return true;
+  referenceDistance = distance;
+  alGetError();
+  int made = 0;
+  for (; made < VOICES; made++) {
+    alGenSources(1, &slots[made].source);
+    if (alGetError() != AL_NO_ERROR) break;
+    slots[made].voice = 0;
+  }
+  if (made < VOICES) {
+    fprintf(stderr, "OpenAL has only %d of the %d sources for sounds\n", made, (int)VOICES);
+    for (int i = 0; i < made; i++) alDeleteSources(1, &slots[i].source);
+    return false;
+  }
+  alDistanceModel(AL_INVERSE_DISTANCE_CLAMPED);
+  clock = 0;
+  started = true;
+  if (background) {
+    running = true;
+    thread = std::thread(&SoundEngine::run, this);
+  }
+  return true;
+}
+
+void SoundEngine::stop() {
+  running = false;
+  if (thread.joinable()) thread.join();
+  if (started) {
+    for (int i = 0; i < VOICES; i++) {
+      alSourceStop(slots[i].source);
+      alDeleteSources(1, &slots[i].source);
+    }
+    started = false;
+  }
+  if (!buffers.empty()) alDeleteBuffers((ALsizei)buffers.size(), &buffers[0]);
+  buffers.clear();
+  active = 0;
+}
+
+void SoundEngine::send(const Command& c) {
+  if (!commands.push(c)) droppedCommands++;
+}
+
+SoundEngine::Voice SoundEngine::play(int sound, float x, float y, float z, int priority, bool loop, float gain) {
+  if (sound < 0 || sound >= (int)buffers.size()) return 0;
+  Command c = {PLAY, loop, nextVoice, sound, priority, gain, {x, y, z, 0, 0, 0}};
+  if (++nextVoice == 0) nextVoice = 1;
+  send(c);
+  return c.voice;
+}
+
+void SoundEngine::move(Voice voice, float x, float y, float z) {
+  Command c = {MOVE, false, voice, 0, 0, 0, {x, y, z, 0, 0, 0}};
+  if (voice) send(c);
+}
+
+void SoundEngine::halt(Voice voice) {
+  Command c = {HALT, false, voice, 0, 0, 0, {0, 0, 0, 0, 0, 0}};
+  if (voice) send(c);
+}
+
+void SoundEngine::listener(float x, float y, float z, float dirX, float dirY, float dirZ) {
+  Command c = {LISTENER, false, 0, 0, 0, 0, {x, y, z, dirX, dirY, dirZ}};
+  send(c);
+}
+
+SoundEngine::Slot* SoundEngine::find(Voice voice) {
+  for (int i = 0; i < VOICES; i++)
+    if (slots[i].voice == voice) return &slots[i];
+  return NULL;
+}
+
+void SoundEngine::apply(const Command& c) {
+  switch (c.type) {
+    case PLAY: {
+      // a free source, or the least important one that isn't more important
+      Slot* s = find(0);
+      if (!s) {
+        for (int i = 0; i < VOICES; i++) {
+          Slot& t = slots[i];
+          if (!s || t.priority < s->priority || (t.priority == s->priority && t.age < s->age)) s = &t;
+        }
+        if (s->priority > c.priority) {
+          droppedCommands++;
+          return;
+        }
+        alSourceStop(s->source);
+      }
+      s->voice = c.voice;
+      s->priority = c.priority;
+      s->age = clock++;
+      alSourcei(s->source, AL_BUFFER, buffers[c.sound]);
+      alSourcei(s->source, AL_LOOPING, c.loop ? AL_TRUE : AL_FALSE);
+      alSourcef(s->source, AL_GAIN, c.gain);
+      alSourcef(s->source, AL_REFERENCE_DISTANCE, referenceDistance);
+      alSource3f(s->source, AL_POSITION, c.v[0], c.v[1], c.v[2]);
+      alSourcePlay(s->source);
+      break;
+    }
+    case MOVE:
+      if (Slot* s = find(c.voice)) alSource3f(s->source, AL_POSITION, c.v[0], c.v[1], c.v[2]);
+      break;
+    case HALT:
+      if (Slot* s = find(c.voice)) {
+        alSourceStop(s->source);
+        s->voice = 0;
+      }
+      break;
+    case LISTENER: {
+      ALfloat orientation[6] = {c.v[3], c.v[4], c.v[5], 0, 1, 0};  // at, then up
+      alListener3f(AL_POSITION, c.v[0], c.v[1], c.v[2]);
+      alListenerfv(AL_ORIENTATION, orientation);
+      break;
+    }
+  }
+}
+
+void SoundEngine::update() {
+  if (!started) return;
+  // free the finished sources first, so new sounds find them idle instead
+  // of stealing or being dropped
+  for (int i = 0; i < VOICES; i++) {
+    Slot& s = slots[i];
+    if (!s.voice) continue;
+    ALint state = AL_STOPPED;
+    alGetSourcei(s.source, AL_SOURCE_STATE, &state);
+    if (state != AL_PLAYING) s.voice = 0;
+  }
+  Command c;
+  while (commands.pop(c)) apply(c);
+  unsigned playing = 0;
+  for (int i = 0; i < VOICES; i++)
+    if (slots[i].voice) playing++;
+  active = playing;
+}
+
+void SoundEngine::run() {
+  // commands wait at most this long, well under a frame
+  while (running) {
+    update();
+    this_thread::sleep_for(chrono::milliseconds(5));
+  }
+}
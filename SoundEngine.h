@@ -0,0 +1,103 @@
+#ifndef SOUND_ENGINE_H
+#define SOUND_ENGINE_H
+
+#include <stdint.h>
+#include <atomic>
+#include <thread>
+#include <vector>
+#include <AL/al.h>
+#include "SpscQueue.h"
+
+// Positional sound effects (footsteps, the door creaking) played on a fixed
+// pool of OpenAL sources by an audio thread.
+//
+// The game never calls OpenAL itself: play(), move(), halt() and listener()
+// only put a command on a lock-free queue and return, and the audio thread
+// makes the al* calls. A full queue drops the command rather than wait.
+//
+// At most VOICES sounds play at once. A new sound takes a free source, or
+// else the one playing the least important sound (the oldest among equals)
+// if that is no more important than the new one; otherwise the new sound is
+// dropped. Finished sources are noticed by the audio thread and freed.
+//
+// Commands come from one thread (SpscQueue), the one that runs the game.
+//
+//   SoundEngine sounds;
+//   int creak = sounds.load("./sounds/door.wav");   // before start()
+//   sounds.start();
+//   sounds.listener(x, y, z, dirX, dirY, dirZ);      // every frame or tick
+//   sounds.play(creak, 0, -10, -1, SoundEngine::PRIORITY_HIGH);
+//
+// With start(false) there is no thread, and update() does its work when
+// called, e.g. between renders of a loopback device.
+class SoundEngine {
+  public:
+    enum { VOICES = 16 };
+    enum { PRIORITY_LOW = 0, PRIORITY_NORMAL = 1, PRIORITY_HIGH = 2 };
+    typedef uint32_t Voice;  // one playing sound, 0 is none
+
+    SoundEngine() : referenceDistance(1), running(false), started(false), nextVoice(1), droppedCommands(0), active(0) {}
+    ~SoundEngine() { stop(); }
+
+    // load a whole .wav into a buffer, before start(); -1 with a message on failure
+    int load(const char* path);
+    // make the sources, distances in world units are heard at full volume
+    // up to 'referenceDistance'; false if OpenAL has no sources to give
+    bool start(bool background = true, float referenceDistance = 1);
+    // stop every sound and free the sources and buffers
+    void stop();
+
+    // start 'sound' at (x, y, z); the voice can be moved or halted later,
+    // and is 0 if 'sound' was never loaded
+    Voice play(int sound, float x, float y, float z, int priority = PRIORITY_NORMAL, bool loop = false, float gain = 1);
+    void move(Voice voice, float x, float y, float z);
+    void halt(Voice voice);
+    // where the player is and which way they look
+    void listener(float x, float y, float z, float dirX, float dirY, float dirZ);
+
+    // audio thread: carry out the queued commands and free finished sources
+    void update();
+
+    // commands lost to a full queue or to busier voices so far
+    unsigned dropped() const { return droppedCommands; }
+    // sources playing after the last update()
+    unsigned activeVoices() const { return active; }
+
+  private:
+    enum { PLAY, MOVE, HALT, LISTENER };
+    struct Command {
+      unsigned char type;
+      bool loop;
+      Voice voice;
+      int sound, priority;
+      float gain;
+      float v[6];  // position, then the direction for LISTENER
+    };
+    struct Slot {
+      ALuint source;
+      Voice voice;    // 0 when free
+      int priority;
+      unsigned age;   // when it started, to steal the oldest first
+    };
+
+    SpscQueue<Command, 256> commands;
+    std::vector<ALuint> buffers;
+    Slot slots[VOICES];
+    float referenceDistance;
+    unsigned clock;
+    std::atomic<bool> running;
+    bool started;
+    Voice nextVoice;
+    std::atomic<unsigned> droppedCommands, active;
+    std::thread thread;
+
+    void send(const Command& c);
+    void apply(const Command& c);
+    Slot* find(Voice voice);
+    void run();
+
+    SoundEngine(const SoundEngine&);
+    SoundEngine& operator=(const SoundEngine&);
+};
+
+#endif
@@ -0,0 +1,86 @@
+#include <algorithm>
+#include <thread>
+#include "SpatialHash.h"
+
+using namespace std;
+
+void SpatialHash::build(const EntitySet& entities) {
+  const size_t n = entities.size();
+  // about two buckets per entity keeps most buckets to one cell
+  unsigned bits = 4;
+  while (((size_t)1 << bits) < 2 * n) bits++;
+  size_t buckets = (size_t)1 << bits;
+  mask = buckets - 1;
+  shift = (bits + 1) / 2;
+  xmask = (1u << shift) - 1;
+  start.assign(buckets + 1, 0);
+  bucketOf.resize(n);
+  order.resize(n);
+  px.resize(n);
+  pz.resize(n);
+  pr.resize(n);
+  pcx.resize(n);
+  pcz.resize(n);
+
+  maxRadius = 0;
+  for (size_t i = 0; i < n; i++) {
+    unsigned b = bucket(cell(entities.x[i]), cell(entities.z[i]));
+    bucketOf[i] = b;
+    start[b + 1]++;
+    maxRadius = max(maxRadius, entities.radius[i]);
+  }
+  // two overlapping entities are less than 2 * maxRadius apart
+  reach = max(1, (int)ceilf(2 * maxRadius * inv));
+  for (size_t b = 0; b < buckets; b++) start[b + 1] += start[b];
+  // scatter, start[b] counts up to where bucket b + 1 begins and is moved back after
+  for (size_t i = 0; i < n; i++) {
+    uint32_t p = start[bucketOf[i]]++;
+    order[p] = i;
+    px[p] = entities.x[i];
+    pz[p] = entities.z[i];
+    pr[p] = entities.radius[i];
+    pcx[p] = cell(px[p]);
+    pcz[p] = cell(pz[p]);
+  }
+  for (size_t b = buckets; b > 0; b--) start[b] = start[b - 1];
+  start[0] = 0;
+}
+
+void SpatialHash::pairsIn(size_t from, size_t to, vector<Pair>* out) const {
+  for (size_t p = from; p < to; p++) {
+    const int cx = pcx[p], cz = pcz[p];
+    // each pair once: with the later entity of the same cell, and with the
+    // cells of the half of the neighbourhood that comes after this one.
+    // Other cells can share a bucket, so every candidate's cell is checked
+    for (int z = cz; z <= cz + reach; z++)
+      for (int x = z == cz ? cx : cx - reach; x <= cx + reach; x++) {
+        unsigned b = bucket(x, z);
+        for (uint32_t q = start[b]; q < start[b + 1]; q++) {
+          if (pcx[q] != x || pcz[q] != z || (x == cx && z == cz && q <= p)) continue;
+          float dx = px[q] - px[p], dz = pz[q] - pz[p], d = pr[p] + pr[q];
+          if (dx * dx + dz * dz < d * d) {
+            Pair pair = {min(order[p], order[q]), max(order[p], order[q])};
+            out->push_back(pair);
+          }
+        }
+      }
+  }
+}
+
+void SpatialHash::pairs(vector<Pair>* out, int threads) const {
+  const size_t n = order.size();
+  if (threads <= 1 || n < 1024) {
+    pairsIn(0, n, out);
+    return;
+  }
+  found.resize(threads);
+  vector<thread> workers;
+  for (int t = 0; t < threads; t++) {
+    found[t].clear();
+    workers.push_back(thread(&SpatialHash::pairsIn, this, n * t / threads, n * (t + 1) / threads, &found[t]));
+  }
+  for (int t = 0; t < threads; t++) {
+    workers[t].join();
+    out->insert(out->end(), found[t].begin(), found[t].end());
+  }
+}
@@ -0,0 +1,106 @@
+#ifndef SPATIAL_HASH_H
+#define SPATIAL_HASH_H
+
+#include <math.h>
+#include <stdint.h>
+#include <stddef.h>
+#include <vector>
+
+// Moving things in the maze (monsters, pickups, other players) as circles,
+// kept as parallel arrays so a pass over every position touches only the
+// positions.
+struct EntitySet {
+  std::vector<float> x, z, radius;
+
+  size_t size() const { return x.size(); }
+  size_t add(float px, float pz, float r) {
+    x.push_back(px);
+    z.push_back(pz);
+    radius.push_back(r);
+    return x.size() - 1;
+  }
+  void clear() { x.clear(); z.clear(); radius.clear(); }
+};
+
+// Broadphase for an EntitySet: which entities are near a point, and which
+// pairs of entities overlap.
+//
+// Space is cut into square cells (a maze cell is a natural size) and every
+// entity goes into the cell holding its centre. Cells are hashed into a table
+// sized to the entity count, so the world can be unbounded and empty space
+// costs nothing: the table is a small grid of buckets repeated over the
+// world, so cells that are neighbours are neighbours in the table too.
+// build() rebuilds it from scratch with a counting sort, O(n) and without
+// allocating once the table has grown, which for entities that all move
+// every tick is cheaper than updating it. The positions are copied in bucket
+// order so a query reads them from consecutive memory.
+//
+//   SpatialHash hash(4);
+//   hash.build(monsters);                 // every tick, after moving them
+//   hash.query(x, z, 1, hit);             // hit(i) for each one touching the player
+//   hash.pairs(&pairs, 4);                // overlapping pairs, on 4 threads
+//
+// Queries answer for the positions at the last build(). They are exact for
+// any radii and fastest when a cell is at least as wide as the largest entity.
+class SpatialHash {
+  public:
+    struct Pair { uint32_t a, b; };  // entity indices, a < b
+
+    explicit SpatialHash(float cellSize) : size(cellSize), inv(1 / cellSize), mask(0), shift(0), xmask(0), reach(0), maxRadius(0) {}
+
+    float cellSize() const { return size; }
+    void build(const EntitySet& entities);
+
+    // f(i) for every entity i that overlaps the circle (x, z, r)
+    template <class F> void query(float x, float z, float r, F f) const {
+      if (order.empty()) return;
+      float far = r + maxRadius;
+      int x0 = cell(x - far), x1 = cell(x + far), z0 = cell(z - far), z1 = cell(z + far);
+      // several cells can share a bucket, each bucket must be visited once
+      unsigned seen[64], n = 0;
+      if ((uint64_t)(x1 - x0 + 1) * (z1 - z0 + 1) > 64) {
+        // wider than a few cells, every entity is as quick
+        for (size_t p = 0; p < order.size(); p++) test(p, x, z, r, f);
+        return;
+      }
+      for (int cz = z0; cz <= z1; cz++)
+        for (int cx = x0; cx <= x1; cx++) {
+          unsigned b = bucket(cx, cz), k = 0;
+          while (k < n && seen[k] != b) k++;
+          if (k < n) continue;
+          seen[n++] = b;
+          for (uint32_t p = start[b]; p < start[b + 1]; p++) test(p, x, z, r, f);
+        }
+    }
+
+    // every overlapping pair once, appended to 'out'; the work is split over
+    // 'threads' threads, the order of the pairs depends on it
+    void pairs(std::vector<Pair>* out, int threads = 1) const;
+
+  private:
+    float size, inv;
+    unsigned mask;               // buckets - 1, a power of two
+    unsigned shift, xmask;       // buckets per row of the table: 1 << shift
+    int reach;                   // cells around a cell that can hold an overlapping entity
+    float maxRadius;
+    std::vector<uint32_t> start; // bucket b holds sorted positions start[b] .. start[b + 1] - 1
+    std::vector<uint32_t> order; // entity at each sorted position
+    std::vector<float> px, pz, pr;  // positions and radii in sorted order
+    std::vector<int> pcx, pcz;      // and their cells
+    std::vector<uint32_t> bucketOf; // scratch for build()
+    mutable std::vector<std::vector<Pair> > found;  // per thread results of pairs()
+
+    int cell(float v) const { return (int)floorf(v * inv); }
+    // the table is a grid of 2^shift by 2^(bits - shift) buckets laid over
+    // the world again and again, so neighbouring cells share cache lines
+    unsigned bucket(int cx, int cz) const { return (((unsigned)cz << shift) + ((unsigned)cx & xmask)) & mask; }
+
+    template <class F> void test(size_t p, float x, float z, float r, F& f) const {
+      float dx = px[p] - x, dz = pz[p] - z, d = r + pr[p];
+      if (dx * dx + dz * dz < d * d) f(order[p]);
+    }
+
+    void pairsIn(size_t from, size_t to, std::vector<Pair>* out) const;
+};
+
+#endif
@@ -0,0 +1,40 @@
+#ifndef SPSC_QUEUE_H
+#define SPSC_QUEUE_H
+
+#include <atomic>
+
+// Lock-free bounded queue for exactly one producer thread and one consumer
+// thread. N must be a power of two; push fails instead of blocking when full.
+template <class T, unsigned N>
+class SpscQueue {
+  private:
+    static_assert((N & (N - 1)) == 0, "SpscQueue size must be a power of two");
+    T items[N];
+    // head is written by the consumer only, tail by the producer only
+    alignas(64) std::atomic<unsigned> head;
+    alignas(64) std::atomic<unsigned> tail;
+  public:
+    SpscQueue() : head(0), tail(0) {}
+
+    bool push(const T& item) {
+      unsigned t = tail.load(std::memory_order_relaxed);
+      if (t - head.load(std::memory_order_acquire) == N) return false;
+      items[t & (N - 1)] = item;
+      tail.store(t + 1, std::memory_order_release);
+      return true;
+    }
+
+    bool pop(T& item) {
+      unsigned h = head.load(std::memory_order_relaxed);
+      if (h == tail.load(std::memory_order_acquire)) return false;
+      item = items[h & (N - 1)];
+      head.store(h + 1, std::memory_order_release);
+      return true;
+    }
+
+    bool empty() const {
+      return head.load(std::memory_order_acquire) == tail.load(std::memory_order_acquire);
+    }
+};
+
+#endif
@@ -0,0 +1,39 @@
+#ifndef TRIPLE_BUFFER_H
+#define TRIPLE_BUFFER_H
+
+#include <atomic>
+
+// Hands the latest value from one writer thread to one reader thread without
+// locks. The writer fills writeBuffer() and calls publish(); the reader gets
+// the most recent published value from read(). Neither side ever waits, and a
+// value being read is never overwritten.
+template <class T>
+class TripleBuffer {
+  private:
+    enum { INDEX_MASK = 3, FRESH = 4 };
+    T slots[3];
+    // index of the slot between writer and reader, FRESH if not read yet
+    std::atomic<unsigned> middle;
+    unsigned back;   // owned by the writer
+    unsigned front;  // owned by the reader
+  public:
+    TripleBuffer() : middle(1), back(0), front(2) {}
+    explicit TripleBuffer(const T& initial) : middle(1), back(0), front(2) {
+      slots[0] = slots[1] = slots[2] = initial;
+    }
+
+    T& writeBuffer() { return slots[back]; }
+
+    void publish() {
+      back = middle.exchange(back | FRESH, std::memory_order_acq_rel) & INDEX_MASK;
+    }
+
+    // stays valid until the next call to read()
+    const T& read() {
+      if (middle.load(std::memory_order_acquire) & FRESH)
+        front = middle.exchange(front, std::memory_order_acq_rel) & INDEX_MASK;
+      return slots[front];
+    }
+};
+
+#endif
@@ -0,0 +1,118 @@
+#include "WavStream.h"
+#include <string.h>
+
+using namespace std;
+
+namespace {
+
+uint32_t le32(const unsigned char* p) { return p[0] | p[1] << 8 | p[2] << 16 | (uint32_t)p[3] << 24; }
+uint16_t le16(const unsigned char* p) { return p[0] | p[1] << 8; }
+
+void put32(unsigned char* p, uint32_t v) { p[0] = v; p[1] = v >> 8; p[2] = v >> 16; p[3] = v >> 24; }
+void put16(unsigned char* p, uint16_t v) { p[0] = v; p[1] = v >> 8; }
+
+}  // namespace
+
+bool WavStream::open(const char* path) {
+  close();
+  file = fopen(path, "rb");
+  if (!file) {
+    perror(path);
+    return false;
+  }
+  unsigned char header[12];
+  if (fread(header, 1, 12, file) != 12 || memcmp(header, "RIFF", 4) || memcmp(header + 8, "WAVE", 4)) {
+    fprintf(stderr, "%s: not a wave file\n", path);
+    close();
+    return false;
+  }
+
+  // chunks of (id, size, data padded to an even size); "fmt " comes before "data"
+  bool haveFormat = false;
+  for (;;) {
+    unsigned char chunk[8];
+    if (fread(chunk, 1, 8, file) != 8) break;
+    uint32_t size = le32(chunk + 4);
+    if (!memcmp(chunk, "fmt ", 4) && size >= 16) {
+      unsigned char fmt[16];
+      if (fread(fmt, 1, 16, file) != 16) break;
+      // 1 is PCM, 0xfffe the extensible format, which this takes to be PCM too
+      uint16_t tag = le16(fmt);
+      channelCount = le16(fmt + 2);
+      rate = le32(fmt + 4);
+      bits = le16(fmt + 14);
+      if ((tag != 1 && tag != 0xfffe) || channelCount < 1 || channelCount > 2 || (bits != 8 && bits != 16) || rate <= 0) {
+        fprintf(stderr, "%s: only 8 and 16-bit PCM in one or two channels can be played\n", path);
+        close();
+        return false;
+      }
+      haveFormat = true;
+      if (fseek(file, (size - 16) + (size & 1), SEEK_CUR)) break;
+    } else if (!memcmp(chunk, "data", 4) && haveFormat) {
+      dataOffset = ftell(file);
+      frameCount = size / frameBytes();
+      position = 0;
+      return true;
+    } else if (fseek(file, size + (size & 1), SEEK_CUR)) {
+      break;
+    }
+  }
+  fprintf(stderr, "%s: no sound data\n", path);
+  close();
+  return false;
+}
+
+void WavStream::close() {
+  if (file) fclose(file);
+  file = NULL;
+  frameCount = position = 0;
+}
+
+size_t WavStream::read(void* out, size_t count) {
+  if (!file) return 0;
+  if (count > frameCount - position) count = frameCount - position;
+  size_t got = fread(out, frameBytes(), count, file);
+  position += got;
+  return got;
+}
+
+bool WavStream::seek(size_t frame) {
+  if (!file || frame > frameCount) return false;
+  if (fseek(file, dataOffset + (long)(frame * frameBytes()), SEEK_SET)) return false;
+  position = frame;
+  return true;
+}
+
+bool saveWav(const char* path, const int16_t* samples, size_t frames, int channels, int sampleRate) {
+  FILE* out = fopen(path, "wb");
+  if (!out) {
+    perror(path);
+    return false;
+  }
+  uint32_t dataBytes = (uint32_t)(frames * channels * 2);
+  unsigned char header[44];
+  memcpy(header, "RIFF", 4);
+  put32(header + 4, 36 + dataBytes);
+  memcpy(header + 8, "WAVEfmt ", 8);
+  put32(header + 16, 16);
+  put16(header + 20, 1);  // PCM
+  put16(header + 22, channels);
+  put32(header + 24, sampleRate);
+  put32(header + 28, sampleRate * channels * 2);
+  put16(header + 32, channels * 2);
+  put16(header + 34, 16);
+  memcpy(header + 36, "data", 4);
+  put32(header + 40, dataBytes);
+  bool ok = fwrite(header, 1, 44, out) == 44;
+  // the samples are little endian in the file, whatever the machine is
+  for (size_t i = 0; ok && i < frames * channels; i++) {
+    unsigned char b[2];
+    put16(b, (uint16_t)samples[i]);
+    ok = fwrite(b, 1, 2, out) == 2;
+  }
+  if (fclose(out) || !ok) {
+    fprintf(stderr, "%s: could not write the sound\n", path);
+    return false;
+  }
+  return true;
+}
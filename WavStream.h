@@ -0,0 +1,56 @@
+#ifndef WAV_STREAM_H
+#define WAV_STREAM_H
+
+#include <stdio.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// A PCM .wav file read a few frames at a time, for streaming: only the
+// header is read by open(), the samples come off the disk as read() asks for
+// them, so a track of any length takes the same memory.
+//
+// Samples are returned as stored, 8-bit unsigned or 16-bit signed little
+// endian, mono or stereo: the formats OpenAL plays directly.
+//
+//   WavStream wav;
+//   if (!wav.open("sounds/test.wav")) ...
+//   size_t n = wav.read(buffer, 4096);   // frames, 0 at the end
+//   wav.rewind();                        // to loop
+class WavStream {
+  public:
+    WavStream() : file(NULL), channelCount(0), rate(0), bits(0), dataOffset(0), frameCount(0), position(0) {}
+    ~WavStream() { close(); }
+
+    // false with a message if the file can't be read or isn't 8 or 16-bit PCM
+    bool open(const char* path);
+    void close();
+    bool isOpen() const { return file != NULL; }
+
+    int channels() const { return channelCount; }
+    int sampleRate() const { return rate; }
+    int bitsPerSample() const { return bits; }
+    size_t frameBytes() const { return (size_t)channelCount * bits / 8; }
+    size_t frames() const { return frameCount; }
+    size_t tell() const { return position; }
+
+    // up to 'count' frames into 'out', fewer at the end of the track
+    size_t read(void* out, size_t count);
+    // back to the first frame
+    bool rewind() { return seek(0); }
+    bool seek(size_t frame);
+
+  private:
+    FILE* file;
+    int channelCount, rate, bits;
+    long dataOffset;     // of the first sample in the file
+    size_t frameCount, position;
+
+    WavStream(const WavStream&);
+    WavStream& operator=(const WavStream&);
+};
+
+// write 16-bit PCM, 'channels' samples interleaved per frame, as a .wav
+// WavStream can read back; false with a message on failure
+bool saveWav(const char* path, const int16_t* samples, size_t frames, int channels, int sampleRate);
+
+#endif
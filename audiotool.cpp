@@ -0,0 +1,167 @@
+/*
+ * Renders the game's audio offline on OpenAL Soft's loopback device (see
+ * AudioLoopback.h), with no sound card, and checks renders against each other.
+ *
+ *   audiotool render <out.wav> [seconds] [rate]   a fixed scene, 16-bit stereo, rate >= 100
+ *   audiotool compare <a.wav> <b.wav> [tolerance] exit 1 if any sample differs by more
+ *   audiotool bench [--benchmark_...]             mixer cost per voice (benchmark.h)
+ *
+ * The scene is scripted in rendered time, not wall time, so two renders of it
+ * by the same OpenAL build are identical: render a reference once with a
+ * build known to sound right, then compare every later render with it.
+ */
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+#include "benchmark.h"
+#include "AudioLoopback.h"
+#include "MusicStream.h"
+#include "SoundEngine.h"
+#include "WavStream.h"
+
+using namespace std;
+
+static int usage() {
+  fprintf(stderr,
+          "usage: audiotool render <out.wav> [seconds] [rate]\n"
+          "       audiotool compare <a.wav> <b.wav> [tolerance]\n"
+          "       audiotool bench [--benchmark_filter=<regex>] [--benchmark_format=console|json] ...\n");
+  return 2;
+}
+
+// the scene: the music, the player walking forward a step every half second
+// as with the UP key, and the door creaking after a second, as with 'o'
+static int render(int argc, char** argv) {
+  if (argc < 3) return usage();
+  double seconds = argc > 3 ? atof(argv[3]) : 4;
+  int rate = argc > 4 ? atoi(argv[4]) : 44100;
+  if (seconds <= 0 || rate < 100) return usage();  // 10 ms blocks need a frame at least
+
+  AudioLoopback out;
+  if (!out.open(rate)) return 1;
+  MusicStream music;
+  SoundEngine sounds;
+  int step = sounds.load("./sounds/step.wav"), door = sounds.load("./sounds/door.wav");
+  if (step < 0 || door < 0 || !music.open("./sounds/test.wav", true) || !sounds.start(false, 20.0)) return 1;
+  music.play(false);
+
+  // 10 ms blocks, like the audio thread waking every few milliseconds
+  const int block = rate / 100;
+  size_t frames = (size_t)(seconds * rate);
+  vector<int16_t> samples(frames * 2);
+  bool creaked = false;
+  int steps = 0;
+  for (size_t done = 0; done < frames; done += block) {
+    double t = (double)done / rate;
+    float z = (float)(-2.0 * steps);
+    sounds.listener(0, 0, z, 0, 0, -1);
+    if (t >= 0.5 * steps) {
+      sounds.play(step, 0, -1, z - 2, SoundEngine::PRIORITY_LOW);
+      steps++;
+    }
+    if (!creaked && t >= 1.0) {
+      sounds.play(door, 0, -10, -1, SoundEngine::PRIORITY_HIGH);
+      creaked = true;
+    }
+    sounds.update();
+    music.pump();
+    int n = frames - done < (size_t)block ? (int)(frames - done) : block;
+    out.render(&samples[done * 2], n);
+  }
+  sounds.stop();
+  music.stop();
+  return saveWav(argv[2], &samples[0], frames, 2, rate) ? 0 : 1;
+}
+
+// a whole 16-bit .wav, or false with a message
+static bool loadWav(const char* path, WavStream& wav, vector<int16_t>& samples) {
+  if (!wav.open(path)) return false;
+  if (wav.bitsPerSample() != 16) {
+    fprintf(stderr, "%s: only 16-bit renders can be compared\n", path);
+    return false;
+  }
+  samples.resize(wav.frames() * wav.channels());
+  if (!samples.empty() && wav.read(&samples[0], wav.frames()) != wav.frames()) {
+    fprintf(stderr, "%s: the sound data is cut short\n", path);
+    return false;
+  }
+  return true;
+}
+
+static int compare(int argc, char** argv) {
+  if (argc < 4) return usage();
+  int tolerance = argc > 4 ? atoi(argv[4]) : 0;
+  WavStream a, b;
+  vector<int16_t> as, bs;
+  if (!loadWav(argv[2], a, as) || !loadWav(argv[3], b, bs)) return 1;
+  if (a.channels() != b.channels() || a.sampleRate() != b.sampleRate() || as.size() != bs.size()) {
+    printf("different formats: %d channels %d Hz %zu frames, %d channels %d Hz %zu frames\n",
+           a.channels(), a.sampleRate(), a.frames(), b.channels(), b.sampleRate(), b.frames());
+    return 1;
+  }
+  int worst = 0;
+  size_t at = 0;
+  double squares = 0;
+  for (size_t i = 0; i < as.size(); i++) {
+    int d = abs(as[i] - bs[i]);
+    if (d > worst) {
+      worst = d;
+      at = i;
+    }
+    squares += (double)d * d;
+  }
+  printf("largest difference %d (frame %zu), rms %.3f, tolerance %d\n",
+         worst, at / a.channels(), as.empty() ? 0.0 : sqrt(squares / as.size()), tolerance);
+  return worst > tolerance ? 1 : 0;
+}
+
+// The time to mix one block with range(0) looping voices around the
+// listener, whose distance and direction change every block so nothing is
+// cached. The label is the cost of one voice on one frame, over the run
+// with no voices; run the /0 case first, as registered, for the baseline.
+static void BM_mixer(BenchState& state) {
+  static AudioLoopback out;
+  static double silentNs = -1;
+  if (!out.sampleRate() && !out.open(44100)) exit(1);
+  const int frames = 1024;
+  int voices = (int)state.range(0);
+
+  SoundEngine sounds;
+  int door = sounds.load("./sounds/door.wav");
+  if (door < 0 || !sounds.start(false, 20.0)) exit(1);
+  for (int v = 0; v < voices; v++) {
+    float a = 6.2831853f * v / voices;
+    sounds.play(door, 10 * cosf(a), 0, 10 * sinf(a), SoundEngine::PRIORITY_NORMAL, true);
+  }
+  sounds.update();
+  vector<int16_t> samples(frames * 2);
+  long long blocks = 0;
+  while (state.KeepRunning()) {
+    float z = (float)(blocks++ % 64) * 0.25f;
+    sounds.listener(0, 0, z, 0, 0, -1);
+    sounds.update();
+    out.render(&samples[0], frames);
+    DoNotOptimize(samples[0]);
+  }
+  sounds.stop();
+
+  state.SetItemsProcessed(state.iterations() * frames * (voices ? voices : 1));
+  double ns = state.cpu_time * 1e9 / (state.iterations() * frames);
+  if (!voices) silentNs = ns;
+  char label[64];
+  if (voices && silentNs >= 0) {
+    snprintf(label, sizeof(label), "%.2f ns per voice frame", (ns - silentNs) / voices);
+    state.SetLabel(label);
+  }
+}
+BENCHMARK(BM_mixer)->Arg(0)->Arg(1)->Arg(4)->Arg(16);
+
+int main(int argc, char** argv) {
+  if (argc < 2) return usage();
+  if (!strcmp(argv[1], "render")) return render(argc, argv);
+  if (!strcmp(argv[1], "compare")) return compare(argc, argv);
+  if (!strcmp(argv[1], "bench")) return runBenchmarks(argc - 1, argv + 1);
+  return usage();
+}
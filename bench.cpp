@@ -0,0 +1,739 @@
+// Microbenchmarks for the parts of the game that run without an OpenGL context:
+// maze generation, collision, image decoding, shader file reading and model
+// vertex conversion.
+//
+//   ./bench --benchmark_format=json --benchmark_out=results.json
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "benchmark.h"
+#include "MazeGenerator.h"
+#include "EllerMaze.h"
+#include "ChunkMaze.h"
+#include "MazeAlgorithms.h"
+#include "MazeFile.h"
+#include "DistanceField.h"
+#include "BlockMaze.h"
+#include "OccupancyGrid.h"
+#include "RayCast.h"
+#include "SpatialHash.h"
+#include "Camera.h"
+#include "Minimap.h"
+#include "file_utils.h"
+#include "shader_source.h"
+#include "bmp_decode.h"
+#include "new/png_load.h"
+#include "new/maze.h"
+#include "new/collision.h"
+#include <learnopengl/vertex.h>
+
+using namespace std;
+
+// scratch file in $TMPDIR, removed again by the benchmark that made it
+static string tempPath(const char* tag, long long n) {
+  const char* dir = getenv("TMPDIR");
+  char buf[512];
+  snprintf(buf, sizeof(buf), "%s/bench_%d_%s_%lld", dir ? dir : "/tmp", (int)getpid(), tag, n);
+  return buf;
+}
+
+static unsigned char pixel(int x, int y, int c) {
+  return (unsigned char)((x * 7 + y * 13 + c * 31) ^ (x * y));
+}
+
+static bool writePNG(const string& path, int w, int h) {
+  FILE* fp = fopen(path.c_str(), "wb");
+  if (!fp) return false;
+  png_structp png = png_create_write_struct(PNG_LIBPNG_VER_STRING, NULL, NULL, NULL);
+  png_infop info = png_create_info_struct(png);
+  if (setjmp(png_jmpbuf(png))) {
+    png_destroy_write_struct(&png, &info);
+    fclose(fp);
+    return false;
+  }
+  png_init_io(png, fp);
+  png_set_IHDR(png, info, w, h, 8, PNG_COLOR_TYPE_RGB, PNG_INTERLACE_NONE,
+               PNG_COMPRESSION_TYPE_DEFAULT, PNG_FILTER_TYPE_DEFAULT);
+  png_write_info(png, info);
+  vector<png_byte> row(w * 3);
+  for (int y = 0; y < h; y++) {
+    for (int x = 0; x < w; x++)
+      for (int c = 0; c < 3; c++) row[x * 3 + c] = pixel(x, y, c);
+    png_write_row(png, &row[0]);
+  }
+  png_write_end(png, NULL);
+  png_destroy_write_struct(&png, &info);
+  fclose(fp);
+  return true;
+}
+
+static void putLE(unsigned char* p, unsigned int v) {
+  p[0] = v & 0xff; p[1] = (v >> 8) & 0xff; p[2] = (v >> 16) & 0xff; p[3] = (v >> 24) & 0xff;
+}
+
+static bool writeBMP(const string& path, int w, int h) {
+  FILE* fp = fopen(path.c_str(), "wb");
+  if (!fp) return false;
+  unsigned int rowSize = w * 3, imageSize = rowSize * h;
+  unsigned char header[54] = {'B', 'M'};
+  putLE(header + 0x02, 54 + imageSize);
+  putLE(header + 0x0A, 54);
+  putLE(header + 0x0E, 40);
+  putLE(header + 0x12, w);
+  putLE(header + 0x16, h);
+  header[0x1A] = 1;
+  header[0x1C] = 24;
+  putLE(header + 0x22, imageSize);
+  fwrite(header, 1, 54, fp);
+  vector<unsigned char> row(rowSize);
+  for (int y = 0; y < h; y++) {
+    for (int x = 0; x < w; x++)
+      for (int c = 0; c < 3; c++) row[x * 3 + c] = pixel(x, y, c);
+    fwrite(&row[0], 1, rowSize, fp);
+  }
+  fclose(fp);
+  return true;
+}
+
+static long long fileSize(const string& path) {
+  FILE* fp = fopen(path.c_str(), "rb");
+  if (!fp) return 0;
+  fseek(fp, 0, SEEK_END);
+  long long n = ftell(fp);
+  fclose(fp);
+  return n;
+}
+
+// ---------------------------------------------------------------- maze generation
+
+// new/main.cpp generator: init_maze + link_node walk, n x n nodes
+static void BM_mazeGen(BenchState& state) {
+  int n = state.range(0);
+  mazeRandom.setSeed(1);
+  while (state.KeepRunning()) {
+    generateNodes(n, n);
+    DoNotOptimize(nodes[n + 1]);
+  }
+  char label[32];
+  snprintf(label, sizeof(label), "%.1f KB nodes", mazeArena.capacity / 1024.0);
+  state.SetLabel(label);
+  state.SetItemsProcessed(state.iterations() * n * n);
+}
+BENCHMARK(BM_mazeGen)->Arg(13)->Arg(65)->Arg(257)->Arg(1025);
+
+// only the link_node walk, without allocating and initialising the nodes
+static void BM_linkNode(BenchState& state) {
+  int n = state.range(0);
+  mazeRandom.setSeed(1);
+  while (state.KeepRunning()) {
+    state.PauseTiming();
+    width = height = n;
+    init_maze();
+    int x = 1, y = 1;
+    set_root(x, y);
+    state.ResumeTiming();
+    while (link_node(&x, &y));
+  }
+  state.SetItemsProcessed(state.iterations() * n * n);
+}
+BENCHMARK(BM_linkNode)->Arg(13)->Arg(65)->Arg(257)->Arg(1025);
+
+// ---------------------------------------------------------------- block maps
+
+// the same algorithm code on compile-time and runtime sized block maps,
+// range(0) x range(0) blocks from the new/main.cpp generator
+template <class M> static void loadBlocks(M& m, int n) {
+  mazeRandom.setSeed(1);
+  generateNodes(n, n);
+  for (int i = 0; i < n; i++)
+    for (int j = 0; j < n; j++) m[i][j] = nodes[j + i * n] & NODE_OPEN ? m.GROUND : m.WALL;
+}
+
+template <class M> static void BM_blockFaces(BenchState& state) {
+  int n = state.range(0);
+  M m(n, n);
+  loadBlocks(m, n);
+  while (state.KeepRunning()) DoNotOptimize(m.exposedFaces());
+  state.SetItemsProcessed(state.iterations() * n * n);
+}
+
+template <class M> static void BM_blockDistances(BenchState& state) {
+  int n = state.range(0);
+  M m(n, n);
+  loadBlocks(m, n);
+  std::vector<int> out(n * n);
+  while (state.KeepRunning()) DoNotOptimize(m.distances(1, 1, &out[0]));
+  state.SetItemsProcessed(state.iterations() * n * n);
+}
+
+typedef FixedMaze<13, 13> FixedMaze13;
+typedef FixedMaze<33, 33> FixedMaze33;
+BENCHMARK(BM_blockFaces<FixedMaze13>)->Arg(13);
+BENCHMARK(BM_blockFaces<FixedMaze33>)->Arg(33);
+BENCHMARK(BM_blockFaces<DynamicMaze>)->Arg(13)->Arg(33);
+BENCHMARK(BM_blockDistances<FixedMaze13>)->Arg(13);
+BENCHMARK(BM_blockDistances<FixedMaze33>)->Arg(33);
+BENCHMARK(BM_blockDistances<DynamicMaze>)->Arg(13)->Arg(33);
+
+// 4096 wall lookups at random blocks of a range(0) x range(0) map, from the
+// byte per block map (0), the bit per block OccupancyGrid one at a time (1)
+// or batched (2), or the 3x3 neighbourhood of each block, 9 byte lookups (3)
+// against OccupancyGrid::window3 (4)
+static void BM_wallLookup(BenchState& state) {
+  const int n = state.range(0), mode = state.range(1), count = 4096;
+  DynamicMaze m(n, n);
+  loadBlocks(m, n);
+  OccupancyGrid occ;
+  occ.assign(m);
+  Random random(1);
+  std::vector<int> qx(count), qz(count);
+  for (int i = 0; i < count; i++) { qx[i] = random.below(n); qz[i] = random.below(n); }
+  std::vector<unsigned char> out(count);
+  while (state.KeepRunning()) {
+    unsigned sum = 0;
+    switch (mode) {
+      case 0: for (int i = 0; i < count; i++) sum += m.wallAt(qx[i], qz[i]); break;
+      case 1: for (int i = 0; i < count; i++) sum += occ.wall(qx[i], qz[i]); break;
+      case 2:
+        occ.walls(&qx[0], &qz[0], count, &out[0]);
+        for (int i = 0; i < count; i++) sum += out[i];
+        break;
+      case 3:
+        for (int i = 0; i < count; i++)
+          for (int dz = -1; dz <= 1; dz++)
+            for (int dx = -1; dx <= 1; dx++) sum += m.wallAt(qx[i] + dx, qz[i] + dz);
+        break;
+      default: for (int i = 0; i < count; i++) sum += occ.window3(qx[i], qz[i]); break;
+    }
+    DoNotOptimize(sum);
+  }
+  static const char* labels[] = {"bytes", "bits", "bits batched", "bytes 3x3", "bits 3x3"};
+  state.SetLabel(labels[mode]);
+  state.SetItemsProcessed(state.iterations() * count);
+}
+BENCHMARK(BM_wallLookup)->Args({257, 0})->Args({257, 1})->Args({257, 2})->Args({257, 3})->Args({257, 4})
+    ->Args({4097, 0})->Args({4097, 1})->Args({4097, 2})->Args({4097, 3})->Args({4097, 4});
+
+// 1024 rays of up to range(1) blocks through a range(0) x range(0) maze, one
+// castRay() at a time (range(2) 1) or castRays() in packets of 8 (range(2) 8).
+// Scattered from random open blocks (range(3) 0), or as a fan from one block
+// of the same maze with three quarters of its walls knocked down (range(3) 1)
+static void BM_rayCast(BenchState& state) {
+  const int n = state.range(0), count = 1024;
+  const bool packets = state.range(2) == 8, fan = state.range(3);
+  DynamicMaze m(n, n);
+  loadBlocks(m, n);
+  Random random(1);
+  if (fan)
+    for (int x = 1; x < n - 1; x++)
+      for (int z = 1; z < n - 1; z++)
+        if (random.below(4)) m[x][z] = m.GROUND;
+  OccupancyGrid occ;
+  occ.assign(m);
+  std::vector<Ray> rays(count);
+  // the fan's origin, one open block for every ray
+  int fanX, fanZ;
+  do { fanX = random.below(n); fanZ = random.below(n); } while (m.wall(fanX, fanZ));
+  for (int i = 0; i < count; i++) {
+    int x = fanX, z = fanZ;
+    if (!fan)
+      do { x = random.below(n); z = random.below(n); } while (m.wall(x, z));
+    float a = fan ? i * 6.2832f / count : random.below(6283) * 0.001f;
+    rays[i] = Ray(x + 0.5f, z + 0.5f, cosf(a), sinf(a), state.range(1));
+  }
+  std::vector<RayHit> hits(count);
+  unsigned char hit[count];
+  while (state.KeepRunning()) {
+    if (packets) {
+      castRays(occ, &rays[0], count, &hits[0], hit);
+    } else {
+      for (int i = 0; i < count; i++) hit[i] = castRay(occ, rays[i], &hits[i]);
+    }
+    DoNotOptimize(hit[0]);
+  }
+  state.SetLabel(string(fan ? "fan, " : "scattered, ") + (packets ? "packets of 8" : "single"));
+  state.SetItemsProcessed(state.iterations() * count);
+}
+BENCHMARK(BM_rayCast)->Args({4097, 30, 1, 0})->Args({4097, 30, 8, 0})
+    ->Args({4097, 30, 1, 1})->Args({4097, 30, 8, 1})->Args({4097, 200, 1, 1})->Args({4097, 200, 8, 1});
+
+static void BM_MazeGenerateMaze(BenchState& state) {
+  int n = state.range(0);
+  while (state.KeepRunning()) {
+    Maze m(n, n);
+    m.setSeed(1);
+    const Grid& g = m.generateMaze();
+    DoNotOptimize(g.openMask(0, 0));
+  }
+  state.SetItemsProcessed(state.iterations() * n * n);
+}
+BENCHMARK(BM_MazeGenerateMaze)->Arg(13)->Arg(50)->Arg(100)->Arg(150)->Arg(1000);
+
+static void BM_MazeGenerateEller(BenchState& state) {
+  int n = state.range(0);
+  while (state.KeepRunning()) {
+    Maze m(n, n);
+    m.setSeed(1);
+    const Grid& g = m.generateEller();
+    DoNotOptimize(g.openMask(0, 0));
+  }
+  state.SetItemsProcessed(state.iterations() * n * n);
+}
+BENCHMARK(BM_MazeGenerateEller)->Arg(13)->Arg(100)->Arg(1000);
+
+// every registered generator on the same square grid: range(0) indexes
+// mazeAlgorithms(), range(1) is the side; the label has the name and the
+// working memory used on top of the grid
+static void BM_mazeAlgorithm(BenchState& state) {
+  const MazeAlgorithm& algorithm = mazeAlgorithms()[state.range(0)];
+  int n = state.range(1);
+  Grid grid(n, n);
+  Random random(1);
+  size_t scratch = 0;
+  while (state.KeepRunning()) {
+    state.PauseTiming();
+    grid.clear();
+    state.ResumeTiming();
+    scratch = algorithm.generate(grid, random);
+    DoNotOptimize(grid.openMask(0, 0));
+  }
+  char label[64];
+  snprintf(label, sizeof(label), "%s %.1f KB", algorithm.name, scratch / 1024.0);
+  state.SetLabel(label);
+  state.SetItemsProcessed(state.iterations() * n * n);
+}
+static Benchmark* registerMazeAlgorithms() {
+  Benchmark* b = registerBenchmark("BM_mazeAlgorithm", BM_mazeAlgorithm);
+  for (size_t i = 0; i < mazeAlgorithms().size(); i++) {
+    b->Args({(long long)i, 100});
+    b->Args({(long long)i, 1000});
+  }
+  return b;
+}
+static Benchmark* maze_algorithm_registration = registerMazeAlgorithms();
+
+// loading a saved range(0) x range(0) maze instead of generating it: open
+// (map + header check) and read one cell
+static void BM_mazeFileOpen(BenchState& state) {
+  int n = state.range(0);
+  char path[] = "/tmp/bench_maze_XXXXXX";
+  int fd = mkstemp(path);
+  if (fd < 0) return;
+  close(fd);
+  Grid grid(n, n);
+  Random random(1);
+  generateEller(grid, random);
+  MazeInfo info;
+  info.algorithm = "eller";
+  saveMaze(path, grid, info);
+  while (state.KeepRunning()) {
+    MazeFile file;
+    file.open(path);
+    DoNotOptimize(file.grid().openMask(n / 2, n / 2));
+  }
+  unlink(path);
+}
+BENCHMARK(BM_mazeFileOpen)->Arg(1000)->Arg(10000);
+
+// distance field over a range(0) x range(0) maze from the middle; range(1) is
+// the generator (mazeAlgorithms() index), range(2) 1 for the bitset search, 0
+// for the queue, range(3) the percentage of extra walls opened
+static void BM_distanceField(BenchState& state) {
+  int n = state.range(0);
+  const MazeAlgorithm& algorithm = mazeAlgorithms()[state.range(1)];
+  Grid grid(n, n);
+  Random random(1);
+  algorithm.generate(grid, random);
+  for (int i = 0; i < state.range(3) * n * n / 100; i++) {
+    // braid: open range(3) percent more walls, which makes loops and wide fronts
+    int x = random.below(n - 1), z = random.below(n - 1);
+    grid.carve(x, z, random.below(2) ? Grid::EAST : Grid::SOUTH);
+  }
+  DistanceField field(grid);
+  while (state.KeepRunning()) {
+    if (state.range(2)) field.computeBits(n / 2, n / 2);
+    else field.computeQueue(n / 2, n / 2);
+    DoNotOptimize(field.distance(0, 0));
+  }
+  char label[64];
+  snprintf(label, sizeof(label), "%s+%lld%% %s", algorithm.name, state.range(3), state.range(2) ? "bitset" : "queue");
+  state.SetLabel(label);
+  state.SetItemsProcessed(state.iterations() * n * n);
+}
+static Benchmark* registerDistanceField() {
+  Benchmark* b = registerBenchmark("BM_distanceField", BM_distanceField);
+  long long cases[][4] = {{64, 0, 0, 0}, {1000, 0, 0, 0}, {1000, 3, 0, 0}, {1000, 0, 0, 10}, {1000, 0, 0, 50}, {1000, 0, 0, 200}};
+  for (size_t i = 0; i < sizeof(cases) / sizeof(cases[0]); i++)
+    for (int bits = 0; bits < 2; bits++)
+      b->Args({cases[i][0], cases[i][1], bits, cases[i][3]});
+  return b;
+}
+static Benchmark* distance_field_registration = registerDistanceField();
+
+// the source walking through a 1000 x 1000 maze one cell per step, as a player would
+static void BM_distanceFieldMove(BenchState& state) {
+  const int n = 1000;
+  Grid grid(n, n);
+  Random random(1);
+  generateBacktracker(grid, random);
+  DistanceField field(grid);
+  int x = n / 2, z = n / 2;
+  field.compute(x, z);
+  while (state.KeepRunning()) {
+    int d = __builtin_ctz(random.pickBit(grid.openMask(x, z)));
+    x += Grid::dx(d);
+    z += Grid::dz(d);
+    field.moveSource(x, z);
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_distanceFieldMove);
+
+// streaming only: 1024 rows of range(0) cells, nothing kept
+static void BM_ellerRows(BenchState& state) {
+  int n = state.range(0);
+  while (state.KeepRunning()) {
+    EllerMaze eller(n, 1);
+    unsigned sum = 0;
+    eller.generate(1024, [&](int z, const unsigned char* cells) { sum += cells[z % n]; });
+    DoNotOptimize(sum);
+  }
+  state.SetItemsProcessed(state.iterations() * n * 1024);
+}
+BENCHMARK(BM_ellerRows)->Arg(16)->Arg(1024)->Arg(16384);
+
+// one chunk of the --infinite world per iteration, range(0) cells a side
+static void BM_chunkBlocks(BenchState& state) {
+  ChunkMaze chunks(7, state.range(0));
+  std::vector<unsigned char> out(chunks.blockSize() * chunks.blockSize());
+  int cx = 0;
+  while (state.KeepRunning()) {
+    chunks.blocks(cx++, 3, &out[0]);
+    DoNotOptimize(out[1]);
+  }
+  state.SetItemsProcessed(state.iterations() * chunks.cells() * chunks.cells());
+}
+BENCHMARK(BM_chunkBlocks)->Arg(8)->Arg(32);
+
+// openMask over every cell of a 1024 x 1024 grid, range(0) is the Grid::Layout
+static void BM_gridOpenMask(BenchState& state) {
+  const int n = 1024;
+  Grid g(n, n, (Grid::Layout)state.range(0));
+  Random random(1);
+  for (int z = 0; z < n; z++)
+    for (int x = 0; x < n; x++) {
+      if (x + 1 < n && random.below(2)) g.carve(x, z, Grid::EAST);
+      if (z + 1 < n && random.below(2)) g.carve(x, z, Grid::SOUTH);
+    }
+  while (state.KeepRunning()) {
+    unsigned sum = 0;
+    for (int z = 0; z < n; z++)
+      for (int x = 0; x < n; x++) sum += g.openMask(x, z);
+    DoNotOptimize(sum);
+  }
+  state.SetLabel(state.range(0) == Grid::TILED ? "tiled" : "row-major");
+  state.SetItemsProcessed(state.iterations() * n * n);
+}
+BENCHMARK(BM_gridOpenMask)->Arg(Grid::ROW_MAJOR)->Arg(Grid::TILED);
+
+// ---------------------------------------------------------------- collision
+
+static void BM_checkCollision(BenchState& state) {
+  mazeRandom.setSeed(1);
+  generateNodes(MAZE_SIZE, MAZE_SIZE);
+  draw();
+  x = 2; z = 2; lx = 0; lz = 1;
+  while (state.KeepRunning()) {
+    bool hit = checkCollision();
+    DoNotOptimize(hit);
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_checkCollision);
+
+// range(0) moves back and forth along the first corridor
+static void BM_computePos(BenchState& state) {
+  int moves = state.range(0);
+  mazeRandom.setSeed(1);
+  generateNodes(MAZE_SIZE, MAZE_SIZE);
+  draw();
+  while (state.KeepRunning()) {
+    x = 2; z = 2; lx = 0; lz = 1;
+    for (int i = 0; i < moves; i++)
+      computePos((i / 16) % 2 ? -0.5f : 0.5f, 0.0f);
+    DoNotOptimize(z);
+  }
+  state.SetItemsProcessed(state.iterations() * moves);
+}
+BENCHMARK(BM_computePos)->Arg(1)->Arg(64)->Arg(1024);
+
+// range(0) agents wandering a 257 x 257 block maze, one sweepCircle each per
+// tick, range(1) / 10 blocks per tick; an agent that hits a wall turns
+static void BM_sweepAgents(BenchState& state) {
+  const int n = 257, agents = state.range(0);
+  const float speed = state.range(1) * 0.2f;
+  DynamicMaze m(n, n);
+  loadBlocks(m, n);
+  struct Wall {
+    const DynamicMaze& m;
+    bool operator()(int bx, int bz) const { return m.wallAt(bx, bz); }
+  } wall = {m};
+  Random random(1);
+  std::vector<float> px(agents), pz(agents), vx(agents), vz(agents);
+  for (int i = 0; i < agents; i++) {
+    int bx, bz;
+    do { bx = random.below(n); bz = random.below(n); } while (m.wall(bx, bz));
+    px[i] = bx * 2; pz[i] = bz * 2;
+    float a = random.below(628) * 0.01f;
+    vx[i] = cosf(a) * speed; vz[i] = sinf(a) * speed;
+  }
+  const SweepGrid blocks(2, 1);
+  unsigned hits = 0;
+  while (state.KeepRunning()) {
+    for (int i = 0; i < agents; i++) {
+      unsigned blocked = sweepCircle(&px[i], &pz[i], vx[i], vz[i], 0.5f, blocks, wall);
+      if (blocked & SWEEP_BLOCKED_X) vx[i] = -vx[i];
+      if (blocked & SWEEP_BLOCKED_Z) vz[i] = -vz[i];
+      hits += blocked != 0;
+    }
+    DoNotOptimize(hits);
+  }
+  state.SetItemsProcessed(state.iterations() * agents);
+}
+BENCHMARK(BM_sweepAgents)->Args({1000, 1})->Args({1000, 10})->Args({1000, 100})->Args({10000, 1});
+
+// range(0) entities of radius 0.5 wandering a world 2 * sqrt(range(0)) maze
+// cells wide; per tick: move them all, rebuild the hash, find the touching
+// pairs on range(1) threads and test the player against them
+static void BM_spatialHash(BenchState& state) {
+  const int n = state.range(0), threads = state.range(1);
+  const float world = 8 * sqrtf(n);
+  Random random(1);
+  EntitySet entities;
+  std::vector<float> vx(n), vz(n);
+  for (int i = 0; i < n; i++) {
+    entities.add(random.below(1 << 20) * world / (1 << 20), random.below(1 << 20) * world / (1 << 20), 0.5f);
+    vx[i] = ((int)random.below(201) - 100) * 0.001f;
+    vz[i] = ((int)random.below(201) - 100) * 0.001f;
+  }
+  SpatialHash hash(4);
+  std::vector<SpatialHash::Pair> pairs;
+  size_t found = 0;
+  while (state.KeepRunning()) {
+    for (int i = 0; i < n; i++) {
+      entities.x[i] += vx[i];
+      entities.z[i] += vz[i];
+    }
+    hash.build(entities);
+    pairs.clear();
+    hash.pairs(&pairs, threads);
+    unsigned near = 0;
+    hash.query(world / 2, world / 2, 0.5f, [&](uint32_t) { near++; });
+    found += pairs.size() + near;
+  }
+  DoNotOptimize(found);
+  char label[32];
+  snprintf(label, sizeof(label), "%.1f pairs", (double)found / state.iterations());
+  state.SetLabel(label);
+  state.SetItemsProcessed(state.iterations() * n);
+}
+BENCHMARK(BM_spatialHash)->Args({1000, 1})->Args({10000, 1})->Args({100000, 1})->Args({100000, 4});
+
+// ---------------------------------------------------------------- camera
+
+// one frame of camera work: fetch the view-projection matrix and test
+// range(0) block spheres against the frustum, with the camera standing
+// still (0), so the cached matrices are reused, or moving every frame (1)
+static void BM_cameraFrame(BenchState& state) {
+  const int n = state.range(0);
+  const bool moving = state.range(1);
+  Random random(1);
+  std::vector<vec3> centres(n);
+  for (int i = 0; i < n; i++)
+    centres[i] = vec3((int)random.below(201) - 100, 0, -(float)random.below(100));
+  Camera camera(vec3(0.0, 0.0, 5.0), vec3(0.0, 0.0, -10.0));
+  camera.updateViewport(1200, 600);
+  float z = 5;
+  size_t visible = 0;
+  while (state.KeepRunning()) {
+    if (moving) {
+      z = z < -40 ? 5 : z - 0.05f;
+      camera.updateCameraCoordinates(vec3(0.0, 0.0, z));
+      camera.updateLookAtVector(vec3(0.0, 0.0, z - 15.0));
+    }
+    DoNotOptimize(camera.getViewProjection());
+    for (int i = 0; i < n; i++) visible += camera.sphereVisible(centres[i], 1.5f);
+  }
+  DoNotOptimize(visible);
+  state.SetItemsProcessed(state.iterations() * n);
+}
+BENCHMARK(BM_cameraFrame)->Args({0, 0})->Args({0, 1})->Args({1024, 0})->Args({1024, 1});
+
+// ---------------------------------------------------------------- minimap
+
+// a range(0) x range(0) block map, every block discovered, drawn whole from
+// the blocks (0) or from the pyramid level that fits 256 pixels (1); or (2)
+// the player moving to a new block: look around and draw what changed
+static void BM_minimap(BenchState& state) {
+  const int n = state.range(0), mode = state.range(1);
+  DynamicMaze m(n, n);
+  loadBlocks(m, n);
+  OccupancyGrid occ;
+  occ.assign(m);
+  Minimap map;
+  map.assign(occ);
+  if (mode < 2)
+    for (int z = 0; z < n; z++)
+      for (int x = 0; x < n; x++) map.discover(x, z);
+  const int level = mode == 1 ? map.levelFor(256) : 0;
+  std::vector<uint32_t> pixels((size_t)map.levelWidth(level) * map.levelHeight(level));
+  Random random(1);
+  while (state.KeepRunning()) {
+    if (mode < 2) {
+      map.render(level, 0, 0, map.levelWidth(level), map.levelHeight(level), &pixels[0]);
+      continue;
+    }
+    int x0, z0, x1, z1;
+    map.look(random.below(n) + 0.5f, random.below(n) + 0.5f, 4);
+    if (map.takeChanges(&x0, &z0, &x1, &z1))
+      map.render(0, x0, z0, x1 - x0 + 1, z1 - z0 + 1, &pixels[0]);
+  }
+  DoNotOptimize(pixels[0]);
+}
+BENCHMARK(BM_minimap)->Args({257, 0})->Args({257, 1})->Args({4097, 0})->Args({4097, 1})->Args({4097, 2});
+
+// ---------------------------------------------------------------- image decoding
+
+// n x n RGB image
+static void BM_pngLoad(BenchState& state) {
+  int n = state.range(0);
+  string path = tempPath("png", n);
+  writePNG(path, n, n);
+  while (state.KeepRunning()) {
+    int w, h;
+    char* data = NULL;
+    png_load(path.c_str(), &w, &h, &data);
+    DoNotOptimize(data);
+    delete[] data;
+  }
+  state.SetBytesProcessed(state.iterations() * fileSize(path));
+  unlink(path.c_str());
+}
+BENCHMARK(BM_pngLoad)->Arg(64)->Arg(256)->Arg(1024);
+
+static void BM_decodeBMP(BenchState& state) {
+  int n = state.range(0);
+  string path = tempPath("bmp", n);
+  writeBMP(path, n, n);
+  while (state.KeepRunning()) {
+    unsigned int w, h;
+    unsigned char* data = decodeBMP(path.c_str(), &w, &h);
+    DoNotOptimize(data);
+    delete[] data;
+  }
+  state.SetBytesProcessed(state.iterations() * fileSize(path));
+  unlink(path.c_str());
+}
+BENCHMARK(BM_decodeBMP)->Arg(64)->Arg(256)->Arg(1024);
+
+// ---------------------------------------------------------------- shader I/O
+
+// file of range(0) bytes
+static void BM_fileRead(BenchState& state) {
+  long long n = state.range(0);
+  string path = tempPath("glsl", n);
+  FILE* fp = fopen(path.c_str(), "wb");
+  for (long long i = 0; i < n; i++) fputc("void main() {}\n"[i % 15], fp);
+  fclose(fp);
+  while (state.KeepRunning()) {
+    char* source = file_read(path.c_str());
+    DoNotOptimize(source);
+    free(source);
+  }
+  state.SetBytesProcessed(state.iterations() * n);
+  unlink(path.c_str());
+}
+BENCHMARK(BM_fileRead)->Range(1 << 10, 8 << 20);
+
+// range(0) define variants of a shader with two nested includes; a cold run
+// flushes the source cache every iteration, a warm one only assembles variants
+static void shaderSourceVariants(BenchState& state, bool cold) {
+  int variants = state.range(0);
+  string top = tempPath("top.glsl", 0), a = tempPath("a.glsl", 0), b = tempPath("b.glsl", 0);
+  FILE* fp = fopen(b.c_str(), "wb");
+  for (int i = 0; i < 200; i++) fprintf(fp, "float b%d(float x) { return x * %d.0; }\n", i, i);
+  fclose(fp);
+  fp = fopen(a.c_str(), "wb");
+  fprintf(fp, "#include \"%s\"\nuniform vec4 light;\n", b.substr(b.rfind('/') + 1).c_str());
+  fclose(fp);
+  fp = fopen(top.c_str(), "wb");
+  fprintf(fp, "#version 120\n#include \"%s\"\nvoid main() { gl_FragColor = light; }\n", a.substr(a.rfind('/') + 1).c_str());
+  fclose(fp);
+
+  vector<string> defines;
+  for (int i = 0; i < variants; i++) {
+    char buf[64];
+    snprintf(buf, sizeof(buf), "LIGHTS=%d;%s", i, i % 2 ? "FOG" : "");
+    defines.push_back(buf);
+  }
+  shader_source_flush();
+  while (state.KeepRunning()) {
+    if (cold) shader_source_flush();
+    for (int i = 0; i < variants; i++) {
+      const char* text = shader_source(top.c_str(), defines[i].c_str());
+      DoNotOptimize(text);
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * variants);
+  shader_source_flush();
+  unlink(top.c_str());
+  unlink(a.c_str());
+  unlink(b.c_str());
+}
+static void BM_shaderSourceCold(BenchState& state) { shaderSourceVariants(state, true); }
+static void BM_shaderSourceWarm(BenchState& state) { shaderSourceVariants(state, false); }
+BENCHMARK(BM_shaderSourceCold)->Arg(1)->Arg(16);
+BENCHMARK(BM_shaderSourceWarm)->Arg(1)->Arg(16);
+
+// ---------------------------------------------------------------- model loading
+
+// Assimp mesh with range(0) vertices converted to the learnopengl Vertex layout
+static void BM_convertVertices(BenchState& state) {
+  unsigned int n = state.range(0);
+  aiMesh mesh;
+  mesh.mNumVertices = n;
+  mesh.mVertices = new aiVector3D[n];
+  mesh.mNormals = new aiVector3D[n];
+  mesh.mTangents = new aiVector3D[n];
+  mesh.mBitangents = new aiVector3D[n];
+  mesh.mTextureCoords[0] = new aiVector3D[n];
+  for (unsigned int i = 0; i < n; i++) {
+    mesh.mVertices[i] = aiVector3D(i, i * 0.5f, -1.0f * i);
+    mesh.mNormals[i] = aiVector3D(0, 1, 0);
+    mesh.mTangents[i] = aiVector3D(1, 0, 0);
+    mesh.mBitangents[i] = aiVector3D(0, 0, 1);
+    mesh.mTextureCoords[0][i] = aiVector3D(i % 2, (i / 2) % 2, 0);
+  }
+  while (state.KeepRunning()) {
+    vector<Vertex> vertices;
+    convertVertices(&mesh, vertices);
+    DoNotOptimize(vertices[n - 1]);
+  }
+  state.SetItemsProcessed(state.iterations() * n);
+  state.SetBytesProcessed(state.iterations() * n * sizeof(Vertex));
+}
+BENCHMARK(BM_convertVertices)->Range(1 << 10, 1 << 20);
+
+int main(int argc, char** argv) {
+  // the code under test reports progress on cout and stderr, keep the results readable
+  cout.setstate(ios::badbit);
+  int devnull = open("/dev/null", O_WRONLY);
+  if (devnull >= 0) dup2(devnull, 2);
+  return runBenchmarks(argc, argv);
+}
@@ -0,0 +1,245 @@
+#ifndef BENCHMARK_H
+#define BENCHMARK_H
+
+// A small microbenchmark harness in the style of Google Benchmark.
+//
+//   void BM_something(BenchState& state) {
+//     setup(state.range(0));
+//     while (state.KeepRunning()) work();
+//     state.SetItemsProcessed(state.iterations() * n);
+//   }
+//   BENCHMARK(BM_something)->Arg(16)->Arg(256);
+//   BENCHMARK_MAIN()
+//
+// Command line flags follow Google Benchmark so its tooling (compare.py) can
+// read the JSON output:
+//   --benchmark_filter=<regex>      only run matching benchmarks
+//   --benchmark_min_time=<seconds>  minimum measuring time per benchmark
+//   --benchmark_format=console|json output format on stdout
+//   --benchmark_out=<file>          also write JSON results to a file
+
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <regex>
+#include <string>
+#include <vector>
+
+class BenchState {
+  private:
+    long long max_iterations, count;
+    std::vector<long long> args;
+    double real_start, cpu_start;
+    bool running;
+    long long items, bytes;
+    std::string label;
+
+    static double now() {
+      struct timespec ts;
+      clock_gettime(CLOCK_MONOTONIC, &ts);
+      return ts.tv_sec + ts.tv_nsec * 1e-9;
+    }
+    static double cpuNow() {
+      struct timespec ts;
+      clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &ts);
+      return ts.tv_sec + ts.tv_nsec * 1e-9;
+    }
+
+  public:
+    double real_time, cpu_time;  // seconds spent in the timed region
+
+    BenchState(long long iterations, const std::vector<long long>& arguments)
+      : max_iterations(iterations), count(0), args(arguments), real_start(0), cpu_start(0),
+        running(false), items(0), bytes(0), real_time(0), cpu_time(0) {}
+
+    // true while there are iterations left, the timer runs from the first call to the last
+    bool KeepRunning() {
+      if (count == 0) ResumeTiming();
+      if (count < max_iterations) { count++; return true; }
+      PauseTiming();
+      return false;
+    }
+    void PauseTiming() {
+      if (!running) return;
+      real_time += now() - real_start;
+      cpu_time += cpuNow() - cpu_start;
+      running = false;
+    }
+    void ResumeTiming() {
+      if (running) return;
+      real_start = now();
+      cpu_start = cpuNow();
+      running = true;
+    }
+    long long range(int i = 0) const { return i < (int)args.size() ? args[i] : 0; }
+    long long iterations() const { return max_iterations; }
+    void SetItemsProcessed(long long n) { items = n; }
+    void SetBytesProcessed(long long n) { bytes = n; }
+    void SetLabel(const std::string& l) { label = l; }
+    long long itemsProcessed() const { return items; }
+    long long bytesProcessed() const { return bytes; }
+    const std::string& getLabel() const { return label; }
+};
+
+typedef void (*BenchFunction)(BenchState&);
+
+class Benchmark {
+  public:
+    std::string name;
+    BenchFunction fn;
+    std::vector<std::vector<long long> > argSets;
+
+    Benchmark(const char* n, BenchFunction f) : name(n), fn(f) {}
+    Benchmark* Arg(long long a) {
+      argSets.push_back(std::vector<long long>(1, a));
+      return this;
+    }
+    // several arguments for one run, range(0), range(1), ...
+    Benchmark* Args(const std::vector<long long>& a) {
+      argSets.push_back(a);
+      return this;
+    }
+    // lo, lo*mult, lo*mult^2, ... up to and including hi
+    Benchmark* Range(long long lo, long long hi, int mult = 8) {
+      for (long long a = lo; a < hi; a *= mult) Arg(a);
+      return Arg(hi);
+    }
+};
+
+inline std::vector<Benchmark*>& benchmarkRegistry() {
+  static std::vector<Benchmark*> registry;
+  return registry;
+}
+
+inline Benchmark* registerBenchmark(const char* name, BenchFunction fn) {
+  Benchmark* b = new Benchmark(name, fn);
+  benchmarkRegistry().push_back(b);
+  return b;
+}
+
+// keep the compiler from optimising away a computed value
+template <class T> inline void DoNotOptimize(T const& value) {
+  asm volatile("" : : "r,m"(value) : "memory");
+}
+
+struct BenchResult {
+  std::string name, label;
+  long long iterations;
+  double real_ns, cpu_ns;  // per iteration
+  double items_per_second, bytes_per_second;
+};
+
+inline void writeBenchJson(FILE* out, const char* executable, const std::vector<BenchResult>& results) {
+  char date[64], host[256] = "unknown";
+  time_t t = time(NULL);
+  strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%S%z", localtime(&t));
+  gethostname(host, sizeof(host));
+  fprintf(out, "{\n  \"context\": {\n");
+  fprintf(out, "    \"date\": \"%s\",\n    \"host_name\": \"%s\",\n    \"executable\": \"%s\",\n", date, host, executable);
+  fprintf(out, "    \"num_cpus\": %ld,\n", sysconf(_SC_NPROCESSORS_ONLN));
+#ifdef __OPTIMIZE__
+  fprintf(out, "    \"library_build_type\": \"release\"\n  },\n");
+#else
+  fprintf(out, "    \"library_build_type\": \"debug\"\n  },\n");
+#endif
+  fprintf(out, "  \"benchmarks\": [\n");
+  for (size_t i = 0; i < results.size(); i++) {
+    const BenchResult& r = results[i];
+    fprintf(out, "    {\n      \"name\": \"%s\",\n      \"run_name\": \"%s\",\n      \"run_type\": \"iteration\",\n",
+            r.name.c_str(), r.name.c_str());
+    fprintf(out, "      \"iterations\": %lld,\n      \"real_time\": %.4f,\n      \"cpu_time\": %.4f,\n      \"time_unit\": \"ns\"",
+            r.iterations, r.real_ns, r.cpu_ns);
+    if (r.items_per_second > 0) fprintf(out, ",\n      \"items_per_second\": %.4e", r.items_per_second);
+    if (r.bytes_per_second > 0) fprintf(out, ",\n      \"bytes_per_second\": %.4e", r.bytes_per_second);
+    if (!r.label.empty()) fprintf(out, ",\n      \"label\": \"%s\"", r.label.c_str());
+    fprintf(out, "\n    }%s\n", i + 1 < results.size() ? "," : "");
+  }
+  fprintf(out, "  ]\n}\n");
+}
+
+inline int runBenchmarks(int argc, char** argv) {
+  std::string filter = ".", format = "console", outFile;
+  double minTime = 0.5;
+  for (int i = 1; i < argc; i++) {
+    const char* a = argv[i];
+    if (!strncmp(a, "--benchmark_filter=", 19)) filter = a + 19;
+    else if (!strncmp(a, "--benchmark_min_time=", 21)) minTime = atof(a + 21);
+    else if (!strncmp(a, "--benchmark_format=", 19)) format = a + 19;
+    else if (!strncmp(a, "--benchmark_out=", 16)) outFile = a + 16;
+    else {
+      printf("usage: %s [--benchmark_filter=<regex>] [--benchmark_min_time=<s>]"
+             " [--benchmark_format=console|json] [--benchmark_out=<file>]\n", argv[0]);
+      return 1;
+    }
+  }
+  std::regex re(filter);
+  bool console = format != "json";
+  if (console) printf("%-44s %14s %14s %12s\n", "Benchmark", "Time", "CPU", "Iterations");
+
+  std::vector<BenchResult> results;
+  std::vector<Benchmark*>& registry = benchmarkRegistry();
+  for (size_t b = 0; b < registry.size(); b++) {
+    std::vector<std::vector<long long> > argSets = registry[b]->argSets;
+    if (argSets.empty()) argSets.push_back(std::vector<long long>());
+    for (size_t a = 0; a < argSets.size(); a++) {
+      std::string name = registry[b]->name;
+      for (size_t k = 0; k < argSets[a].size(); k++) {
+        char buf[32];
+        snprintf(buf, sizeof(buf), "/%lld", argSets[a][k]);
+        name += buf;
+      }
+      if (!std::regex_search(name, re)) continue;
+
+      // grow the iteration count until one run lasts at least minTime
+      long long iters = 1;
+      while (true) {
+        BenchState state(iters, argSets[a]);
+        registry[b]->fn(state);
+        state.PauseTiming();
+        if (state.real_time >= minTime || iters >= 1000000000LL) {
+          BenchResult r;
+          r.name = name;
+          r.label = state.getLabel();
+          r.iterations = iters;
+          r.real_ns = state.real_time * 1e9 / iters;
+          r.cpu_ns = state.cpu_time * 1e9 / iters;
+          r.items_per_second = state.itemsProcessed() / state.real_time;
+          r.bytes_per_second = state.bytesProcessed() / state.real_time;
+          results.push_back(r);
+          if (console) {
+            printf("%-44s %11.0f ns %11.0f ns %12lld", name.c_str(), r.real_ns, r.cpu_ns, iters);
+            if (r.bytes_per_second > 0) printf(" %9.2f MB/s", r.bytes_per_second / (1024.0 * 1024.0));
+            if (r.items_per_second > 0) printf(" %9.3fM items/s", r.items_per_second * 1e-6);
+            if (!r.label.empty()) printf(" %s", r.label.c_str());
+            printf("\n");
+            fflush(stdout);
+          }
+          break;
+        }
+        double scale = state.real_time > 0 ? minTime * 1.4 / state.real_time : 10.0;
+        if (scale > 10.0) scale = 10.0;
+        long long next = (long long)(iters * scale);
+        iters = next > iters ? next : iters + 1;
+      }
+    }
+  }
+
+  if (!console) writeBenchJson(stdout, argv[0], results);
+  if (!outFile.empty()) {
+    FILE* out = fopen(outFile.c_str(), "w");
+    if (!out) { printf("could not write %s: %s\n", outFile.c_str(), strerror(errno)); return 1; }
+    writeBenchJson(out, argv[0], results);
+    fclose(out);
+  }
+  return 0;
+}
+
+#define BENCH_CONCAT2(a, b) a##b
+#define BENCH_CONCAT(a, b) BENCH_CONCAT2(a, b)
+#define BENCHMARK(fn) static Benchmark* BENCH_CONCAT(bench_registration_, __LINE__) = registerBenchmark(#fn, fn)
+#define BENCHMARK_MAIN() int main(int argc, char** argv) { return runBenchmarks(argc, argv); }
+
+#endif
@@ -0,0 +1,8 @@
+#ifndef BMP_DECODE_H
+#define BMP_DECODE_H
+
+// Read a 24bpp .BMP file into memory without touching OpenGL.
+// Returns BGR pixel rows (bottom-up) allocated with new[], or NULL on error.
+unsigned char * decodeBMP(const char * imagepath, unsigned int * width, unsigned int * height);
+
+#endif
@@ -0,0 +1,76 @@
+/**
+ * From the OpenGL Programming wikibook: http://en.wikibooks.org/wiki/OpenGL_Programming
+ * This file is in the public domain.
+ * Contributors: Sylvain Beucler
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+/*
+ * Store all the file's contents in memory, NUL terminated, and its length in
+ * 'size' if not NULL. Regular files are read with one read of their stat()
+ * size; pipes and files that grow while being read fall back to doubling.
+ */
+char* file_read_size(const char* filename, size_t* size) {
+  int fd = open(filename, O_RDONLY);
+  if (fd < 0) return NULL;
+
+  struct stat st;
+  size_t capacity = BUFSIZ;
+  if (fstat(fd, &st) == 0 && S_ISREG(st.st_mode))
+    capacity = (size_t)st.st_size;
+
+  char* res = (char*)malloc(capacity + 1);
+  size_t total = 0;
+  while (res != NULL) {
+    if (total == capacity) {
+      /* one byte is enough to tell EOF from a file that is still growing */
+      char probe;
+      ssize_t n = read(fd, &probe, 1);
+      if (n == 0) break;
+      if (n < 0) {
+        if (errno == EINTR) continue;
+        free(res);
+        res = NULL;
+        break;
+      }
+      capacity = capacity ? capacity * 2 : BUFSIZ;
+      char* grown = (char*)realloc(res, capacity + 1);
+      if (grown == NULL) {
+        free(res);
+        res = NULL;
+        break;
+      }
+      res = grown;
+      res[total++] = probe;
+      continue;
+    }
+    ssize_t n = read(fd, res + total, capacity - total);
+    if (n == 0) break;
+    if (n < 0) {
+      if (errno == EINTR) continue;
+      free(res);
+      res = NULL;
+      break;
+    }
+    total += n;
+  }
+
+  int saved_errno = errno;
+  close(fd);
+  errno = saved_errno;
+  if (res == NULL) return NULL;
+  res[total] = '\0';
+  if (size) *size = total;
+  return res;
+}
+
+/* Store all the file's contents in memory, useful to pass shaders source code to OpenGL */
+char* file_read(const char* filename) {
+  return file_read_size(filename, NULL);
+}
@@ -0,0 +1,7 @@
+#ifndef _FILE_UTILS_H
+#define _FILE_UTILS_H
+#include <stddef.h>
+/* Kept apart from shader_utils so it can be used without OpenGL */
+char* file_read(const char* filename);
+char* file_read_size(const char* filename, size_t* size);
+#endif
@@ -19,6 +19,8 @@
 #include "texture.hpp"
 #include "Camera.h"
 #include "MazeGenerator.h"
+#include "MusicStream.h"
+#include "SoundEngine.h"
 
 using namespace std;
 
@@ -67,24 +69,12 @@ Camera camera(vec3(0.0, 0.0, 5.0), vec3(0.0, 0.0, -10.0));  // view in the negat
 Maze m(100,100);
 
 int compile_link_shaders(char* vshader_filename, char* fshader_filename){
-    GLint link_ok = GL_FALSE;
     GLint validate_ok = GL_FALSE;
-    GLuint vs, fs;
 
-    if ((vs = create_shader(vshader_filename, GL_VERTEX_SHADER))   == 0) { return 0; }
-    if ((fs = create_shader(fshader_filename, GL_FRAGMENT_SHADER)) == 0) { return 0; }
-
-    program = glCreateProgram();
-    glAttachShader(program, vs);
-    glAttachShader(program, fs);
-    glLinkProgram(program);
-    glGetProgramiv(program, GL_LINK_STATUS, &link_ok);
-
-    if (!link_ok) {
-        fprintf(stderr, "glLinkProgram:");
-        print_log(program);
-        return 0;
-    }
+    // loaded from the program binary cache when the sources and driver are unchanged
+    struct program_desc desc = { vshader_filename, NULL, fshader_filename };
+    if (!create_programs(&desc, 1)) { return 0; }
+    program = desc.program;
 
     glValidateProgram(program);
     glGetProgramiv(program, GL_VALIDATE_STATUS, &validate_ok);
@@ -237,64 +227,45 @@ void gameWonScreen(){
   writeText(vec3(0.0, 0.0, 0.0), vec3(-20.0, 40.0, G.z_start+0.01), "Press q to quit and r to replay.");
 }
 
-// Add music while game is in progress
-int initMusic() {
-  int NUM_BUFFERS = 1;
-  int NUM_SOURCES = 1;
-	alGetError();
-
-	ALuint buffers[NUM_BUFFERS];
-	int error;
-	// Create the buffers
-	alGenBuffers(1, buffers);
-	if ((error = alGetError()) != AL_NO_ERROR) {
-	  printf("ERROR::0: alGenBuffers : %d", error);
-	  return 0;
-	}
-
-	ALenum     format;
-	ALsizei    size;
-	ALsizei    freq;
-	ALboolean  loop;
-	ALvoid*    data;
-
-	char *path = (char *)"./sounds/test.wav";
-	buffers[0] = alutCreateBufferFromFile(path);
-	if ((error = alGetError()) != AL_NO_ERROR) {
-	  printf("ERROR::1: alBufferData buffer 0 : %d\n", error);
-	  alDeleteBuffers(NUM_BUFFERS, buffers);
-	  return 0;
-	}
-
-	if((error = alutGetError())) { cout<<"File error:"<<alutGetErrorString(error)<<endl; }
+// Add music while game is in progress, streamed from disk a few chunks at a time
+MusicStream music;
 
-	ALuint source[NUM_SOURCES];
-	// Generate the sources
-	alGenSources(NUM_SOURCES, source);
-	if ((error = alGetError()) != AL_NO_ERROR) {
-	  printf("ERROR::2: alGenSources : %d", error);
-	  return 0;
-	}
-	alSourcei(source[0], AL_LOOPING, AL_TRUE);
-	alSourcei(source[0], AL_BUFFER, buffers[0]);
-	if ((error = alGetError()) != AL_NO_ERROR) {
-	  printf("ERROR::3: alSourcei : %d", error);
-	  return 0;
-	}
+int initMusic() {
+	if (!music.open("./sounds/test.wav", true)) return 0;
 
+	ALuint source = music.alSource();
 	ALfloat listenerOri[] = { 0.0f, 0.0f, 1.0f, 0.0f, 1.0f, 0.0f };
-  alSource3f (source[0], AL_POSITION, 0,0,0);
-  alSource3f (source[0], AL_VELOCITY, 0,0,0);
-  alSource3f (source[0], AL_DIRECTION, 0,0,1);
+  alSource3f (source, AL_POSITION, 0,0,0);
+  alSource3f (source, AL_VELOCITY, 0,0,0);
+  alSource3f (source, AL_DIRECTION, 0,0,1);
 
 	// alListener3f(AL_POSITION,0,0,1.0);
 	alListener3f(AL_VELOCITY,0,0,0);
 	alListenerfv(AL_ORIENTATION,listenerOri);
   printf("Play the musikkk!\n");
-	alSourcePlay(source[0]);
+	music.play();
 	return 1;
 }
 
+// Sound effects, played by the audio thread of SoundEngine
+SoundEngine sounds;
+int soundStep = -1, soundDoor = -1;
+unsigned listenerVersion = 0;  // camera version the listener was last placed at
+
+int initSounds() {
+  soundStep = sounds.load("./sounds/step.wav");
+  soundDoor = sounds.load("./sounds/door.wav");
+  // the door is 40 units wide, full volume within about a door's width
+  return sounds.start(true, 20.0);
+}
+
+// the audio threads have to stop before the OpenAL context goes away
+void stopAudio() {
+  sounds.stop();
+  music.stop();
+  alutExit();
+}
+
 void renderDoorWall(){
   vector <vec2> t = {vec2(0.0, 0.0), vec2(5.0, 0.0), vec2(5.0, 5.0), vec2(0.0, 5.0)};
   text = loadBMP_custom((char *) "./images/brick_wall.bmp"); // surrounding of the entrance door
@@ -425,6 +396,7 @@ void normalKeys( unsigned char key, int x, int y ) {
   if(key==27 || key=='q') exit(0);  //escape key
   if(key=='o'){
     // open the door
+    if(G.gameStatus==GAME_ON) sounds.play(soundDoor, 0.0, -10.0, G.z_start, SoundEngine::PRIORITY_HIGH);
     G.gameStatus = DOOR_ON;
   }
   glutPostRedisplay();
@@ -451,10 +423,13 @@ void specialKeys(int key, int x, int y){
     case GLUT_KEY_UP:
       camera.updateCameraCoordinates(vec3(camera_coordinates.x, camera_coordinates.y, camera_coordinates.z-2.0));
       camera.updateLookAtVector(vec3(0.0, 0.0, camera_coordinates.z-10.0));
+      // footsteps on the floor below the camera
+      sounds.play(soundStep, camera_coordinates.x, -G.door_height/2, camera_coordinates.z-2.0, SoundEngine::PRIORITY_LOW);
       break;
     case GLUT_KEY_DOWN:
       camera.updateCameraCoordinates(vec3(camera_coordinates.x, camera_coordinates.y, camera_coordinates.z+2.0));
       camera.updateLookAtVector(vec3(0.0, 0.0, camera_coordinates.z+10.0));
+      sounds.play(soundStep, camera_coordinates.x, -G.door_height/2, camera_coordinates.z+2.0, SoundEngine::PRIORITY_LOW);
       break;
     default: break;
   }
@@ -467,19 +442,23 @@ void display(void) {
 
     cout<<"gameStatus: "<<G.gameStatus<<"\n";
 
+    // the camera keeps both matrices and rebuilds them only after it moved
     glMatrixMode(GL_PROJECTION);
-    glLoadIdentity();
-    vec4 lrbt = camera.getlrbt();
-    vec2 zplanes = camera.getZplanes();
-    glFrustum(lrbt.x, lrbt.y,  lrbt.z, lrbt.w, zplanes.x, zplanes.y);
+    glLoadMatrixf(glm::value_ptr(camera.getProjection()));
     glMatrixMode(GL_MODELVIEW);
-    glLoadIdentity();
+    glLoadMatrixf(glm::value_ptr(camera.getView()));
 
+    const vec4& lrbt = camera.getlrbt();
+    const vec2& zplanes = camera.getZplanes();
     vec3 camera_coordinates = camera.getCameraCoordinates();
     vec3 look_at = camera.getLookAtVector();
-    gluLookAt(camera_coordinates.x, camera_coordinates.y, camera_coordinates.z,
-              look_at.x, look_at.y, look_at.z,
-              0.0, 1.0, 0.0);
+
+    // the listener follows the camera, told only when it moved
+    if (camera.getVersion() != listenerVersion) {
+      listenerVersion = camera.getVersion();
+      vec3 dirn = look_at - camera_coordinates;
+      sounds.listener(camera_coordinates.x, camera_coordinates.y, camera_coordinates.z, dirn.x, dirn.y, dirn.z);
+    }
 
     cout<<"camera_coordinates: ("<<camera_coordinates.x<<" , "<<camera_coordinates.y<<" , "<<camera_coordinates.z<<")\n";
     cout<<"look_at: ("<<look_at.x<<" , "<<look_at.y<<" , "<<look_at.z<<")\n";
@@ -525,6 +504,7 @@ void init (void) {
 
 void reshape (int w, int h) {
    glViewport(0, 0, (GLsizei) w, (GLsizei) h);
+   camera.updateViewport(w, h);
   //  glMatrixMode(GL_PROJECTION);
   //  glLoadIdentity();
   //  vec4 lrbt = camera.getlrbt();
@@ -557,6 +537,16 @@ int main(int argc, char** argv) {
   if(response==0) return 0;
 
   init ();
+
+  // the game goes on without music when there is no sound device
+  if (alutInit(&argc, argv)) {
+    atexit(stopAudio);
+    initSounds();
+    initMusic();
+  } else {
+    fprintf(stderr, "No sound: %s\n", alutGetErrorString(alutGetError()));
+  }
+
   glutDisplayFunc (display);
   glutReshapeFunc (reshape);
   glutMouseFunc(clickStart);
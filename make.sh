@@ -2,17 +2,65 @@
 
 echo "Compiling the code..."
 
+# every file that includes Camera.h needs the same GLM_ flags, they change the layout of its matrices
+
 echo "g++ -ggdb -std=c++11 -c -o shader_utils.o shader_utils.cpp"
 g++ -ggdb -std=c++11 -c -o shader_utils.o shader_utils.cpp
 
+echo "g++ -ggdb -std=c++11 -ILearnOpenGL/includes -c -o program_cache.o program_cache.cpp"
+g++ -ggdb -std=c++11 -ILearnOpenGL/includes -c -o program_cache.o program_cache.cpp
+
+echo "g++ -ggdb -std=c++11 -c -o shader_source.o shader_source.cpp"
+g++ -ggdb -std=c++11 -c -o shader_source.o shader_source.cpp
+
+echo "g++ -ggdb -std=c++11 -c -o file_utils.o file_utils.cpp"
+g++ -ggdb -std=c++11 -c -o file_utils.o file_utils.cpp
+
 echo "g++ -ggdb -std=c++11 -c -o texture.o texture.cpp"
 g++ -ggdb -std=c++11 -c -o texture.o texture.cpp
 
+echo "g++ -ggdb -std=c++11 -c -o bmp_decode.o bmp_decode.cpp"
+g++ -ggdb -std=c++11 -c -o bmp_decode.o bmp_decode.cpp
+
+echo "g++ -ggdb -std=c++11 -c -o grid.o Grid.cpp"
+g++ -ggdb -std=c++11 -c -o grid.o Grid.cpp
+
+echo "g++ -ggdb -std=c++11 -c -o eller.o EllerMaze.cpp"
+g++ -ggdb -std=c++11 -c -o eller.o EllerMaze.cpp
+
+echo "g++ -ggdb -std=c++11 -c -o algorithms.o MazeAlgorithms.cpp"
+g++ -ggdb -std=c++11 -c -o algorithms.o MazeAlgorithms.cpp
+
 echo "g++ -ggdb -std=c++11 -c -o maze.o MazeGenerator.cpp"
 g++ -ggdb -std=c++11 -c -o maze.o MazeGenerator.cpp
 
-echo "g++ -ggdb -std=c++11 -c -o camera.o Camera.cpp"
-g++ -ggdb -std=c++11 -c -o camera.o Camera.cpp
+echo "g++ -ggdb -std=c++11 -DGLM_FORCE_INTRINSICS -c -o camera.o Camera.cpp"
+g++ -ggdb -std=c++11 -DGLM_FORCE_INTRINSICS -c -o camera.o Camera.cpp
+
+echo "g++ -ggdb -std=c++11 -c -o wav_stream.o WavStream.cpp"
+g++ -ggdb -std=c++11 -c -o wav_stream.o WavStream.cpp
+
+echo "g++ -ggdb -std=c++11 -c -o music_stream.o MusicStream.cpp"
+g++ -ggdb -std=c++11 -c -o music_stream.o MusicStream.cpp
+
+echo "g++ -ggdb -std=c++11 -c -o sound_engine.o SoundEngine.cpp"
+g++ -ggdb -std=c++11 -c -o sound_engine.o SoundEngine.cpp
+
+echo "g++ -ggdb -std=c++11 -DGLM_FORCE_INTRINSICS main.cpp shader_utils.o shader_source.o program_cache.o file_utils.o texture.o bmp_decode.o camera.o grid.o eller.o algorithms.o maze.o wav_stream.o music_stream.o sound_engine.o -lglut -lGLEW -lGL -lGLU -lm -lalut -lopenal -lpthread -o game"
+g++ -ggdb -std=c++11 -DGLM_FORCE_INTRINSICS main.cpp shader_utils.o shader_source.o program_cache.o file_utils.o texture.o bmp_decode.o camera.o grid.o eller.o algorithms.o maze.o wav_stream.o music_stream.o sound_engine.o -lglut -lGLEW -lGL -lGLU -lm -lalut -lopenal -lpthread -o game
+
+echo "Compiling the benchmarks..."
+
+# optimised build, needs no OpenGL context; run ./bench --benchmark_format=json for machine readable results
+echo "g++ -O2 -std=c++11 -DGLM_FORCE_INTRINSICS -I. -ILearnOpenGL/includes bench.cpp Grid.cpp EllerMaze.cpp ChunkMaze.cpp MazeAlgorithms.cpp MazeFile.cpp DistanceField.cpp OccupancyGrid.cpp RayCast.cpp SpatialHash.cpp Camera.cpp Minimap.cpp MazeGenerator.cpp file_utils.cpp shader_source.cpp bmp_decode.cpp -lpng -lpthread -o bench"
+g++ -O2 -std=c++11 -DGLM_FORCE_INTRINSICS -I. -ILearnOpenGL/includes bench.cpp Grid.cpp EllerMaze.cpp ChunkMaze.cpp MazeAlgorithms.cpp MazeFile.cpp DistanceField.cpp OccupancyGrid.cpp RayCast.cpp SpatialHash.cpp Camera.cpp Minimap.cpp MazeGenerator.cpp file_utils.cpp shader_source.cpp bmp_decode.cpp -lpng -lpthread -o bench
+
+echo "Compiling the tools..."
+
+# mazetool generates, inspects and converts .maze files
+echo "g++ -O2 -std=c++11 -I. mazetool.cpp MazeFile.cpp DistanceField.cpp MazeAlgorithms.cpp EllerMaze.cpp Grid.cpp file_utils.cpp -o mazetool"
+g++ -O2 -std=c++11 -I. mazetool.cpp MazeFile.cpp DistanceField.cpp MazeAlgorithms.cpp EllerMaze.cpp Grid.cpp file_utils.cpp -o mazetool
 
-echo "g++ -ggdb -std=c++11 main.cpp shader_utils.o texture.o camera.o maze.o -lglut -lGLEW -lGL -lGLU -lm -lalut -lopenal -o game"
-g++ -ggdb -std=c++11 main.cpp shader_utils.o texture.o camera.o maze.o -lglut -lGLEW -lGL -lGLU -lm -lalut -lopenal -o game
+# audiotool renders the game's audio offline, without a sound card, and compares renders
+echo "g++ -O2 -std=c++11 -I. audiotool.cpp AudioLoopback.cpp MusicStream.cpp SoundEngine.cpp WavStream.cpp -lopenal -lpthread -o audiotool"
+g++ -O2 -std=c++11 -I. audiotool.cpp AudioLoopback.cpp MusicStream.cpp SoundEngine.cpp WavStream.cpp -lopenal -lpthread -o audiotool
@@ -0,0 +1,155 @@
+/*
+ * Generates, inspects and converts .maze files (see MazeFile.h).
+ *
+ *   mazetool generate <algorithm> <width> <height> <seed> <out.maze> [tiled] [distances]
+ *   mazetool info <file.maze>
+ *   mazetool verify <file.maze>
+ *   mazetool export <file.maze>              walls as text, '#' wall ' ' open
+ *   mazetool import <file.txt> <out.maze>    the text export (or new/main's draw()) back
+ *   mazetool relayout <in.maze> <out.maze> row|tiled
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <vector>
+#include "file_utils.h"
+#include "DistanceField.h"
+#include "MazeAlgorithms.h"
+#include "MazeFile.h"
+
+using namespace std;
+
+static int usage() {
+  fprintf(stderr,
+          "usage: mazetool generate <algorithm> <width> <height> <seed> <out.maze> [tiled] [distances]\n"
+          "       mazetool info <file.maze>\n"
+          "       mazetool verify <file.maze>\n"
+          "       mazetool export <file.maze>\n"
+          "       mazetool import <file.txt> <out.maze>\n"
+          "       mazetool relayout <in.maze> <out.maze> row|tiled\n"
+          "algorithms:");
+  for (size_t i = 0; i < mazeAlgorithms().size(); i++) fprintf(stderr, " %s", mazeAlgorithms()[i].name);
+  fprintf(stderr, "\n");
+  return 2;
+}
+
+static int generate(int argc, char** argv) {
+  if (argc < 7) return usage();
+  const MazeAlgorithm* algorithm = findMazeAlgorithm(argv[2]);
+  int w = atoi(argv[3]), h = atoi(argv[4]);
+  if (algorithm == NULL || w <= 0 || h <= 0) return usage();
+  bool tiled = false, distances = false;
+  for (int i = 7; i < argc; i++) {
+    if (!strcmp(argv[i], "tiled")) tiled = true;
+    else if (!strcmp(argv[i], "distances")) distances = true;
+    else return usage();
+  }
+  MazeInfo info;
+  info.seed = strtoull(argv[5], NULL, 0);
+  info.algorithm = algorithm->name;
+  Grid grid(w, h, tiled ? Grid::TILED : Grid::ROW_MAJOR);
+  Random rng(info.seed);
+  algorithm->generate(grid, rng);
+  // the diamond goes as far as possible from the start cell (0,0)
+  DistanceField field(grid);
+  field.compute(0, 0);
+  field.farthest(&info.diamondX, &info.diamondZ);
+  return saveMaze(argv[6], grid, info, distances ? field.data() : NULL) ? 0 : 1;
+}
+
+static int info(const char* path) {
+  MazeFile file;
+  if (!file.open(path)) return 1;
+  const Grid& g = file.grid();
+  printf("%s: %d x %d cells, %s layout, %zu bytes of walls\n", path, g.width(), g.height(),
+         g.getLayout() == Grid::TILED ? "tiled" : "row-major", g.bytes());
+  printf("algorithm %s, seed %llu, diamond at (%d, %d), %s\n", file.info().algorithm.c_str(), file.info().seed,
+         file.info().diamondX, file.info().diamondZ, file.distances() ? "with distances" : "no distances");
+  return 0;
+}
+
+static int verify(const char* path) {
+  MazeFile file;
+  if (!file.open(path)) return 1;
+  if (!file.verify()) {
+    fprintf(stderr, "%s: checksum mismatch\n", path);
+    return 1;
+  }
+  printf("%s: ok\n", path);
+  return 0;
+}
+
+static int exportText(const char* path) {
+  MazeFile file;
+  if (!file.open(path)) return 1;
+  const Grid& g = file.grid();
+  string line;
+  for (int bz = 0; bz <= 2 * g.height(); bz++) {
+    line.assign(2 * g.width() + 1, '#');
+    if (bz % 2)
+      for (int x = 0; x < g.width(); x++) {
+        line[2 * x + 1] = ' ';
+        if (g.passage(x, bz / 2, Grid::EAST)) line[2 * x + 2] = ' ';
+      }
+    else if (bz > 0)
+      for (int x = 0; x < g.width(); x++)
+        if (g.passage(x, bz / 2 - 1, Grid::SOUTH)) line[2 * x + 1] = ' ';
+    printf("%s\n", line.c_str());
+  }
+  return 0;
+}
+
+static int importText(const char* in, const char* out) {
+  char* text = file_read(in);
+  if (text == NULL) {
+    perror(in);
+    return 1;
+  }
+  vector<string> rows;
+  for (char* line = strtok(text, "\n"); line; line = strtok(NULL, "\n"))
+    if (strchr(line, '#')) rows.push_back(line);
+  free(text);
+  // cells sit on odd rows and columns, the blocks between them are walls or passages
+  int w = rows.empty() ? 0 : (rows[0].size() - 1) / 2, h = (rows.size() - 1) / 2;
+  if (w <= 0 || h <= 0) {
+    fprintf(stderr, "%s: no maze found\n", in);
+    return 1;
+  }
+  Grid grid(w, h);
+  for (int z = 0; z < h; z++)
+    for (int x = 0; x < w; x++) {
+      const string& row = rows[2 * z + 1];
+      if (x + 1 < w && (size_t)(2 * x + 2) < row.size() && row[2 * x + 2] != '#') grid.carve(x, z, Grid::EAST);
+      const string& below = rows[2 * z + 2];
+      if (z + 1 < h && (size_t)(2 * x + 1) < below.size() && below[2 * x + 1] != '#') grid.carve(x, z, Grid::SOUTH);
+    }
+  MazeInfo info;
+  info.algorithm = "import";
+  return saveMaze(out, grid, info) ? 0 : 1;
+}
+
+static int relayout(const char* in, const char* out, const char* layout) {
+  MazeFile file;
+  if (!file.open(in)) return 1;
+  const Grid& g = file.grid();
+  Grid copy(g.width(), g.height(), !strcmp(layout, "tiled") ? Grid::TILED : Grid::ROW_MAJOR);
+  for (int z = 0; z < g.height(); z++)
+    for (int x = 0; x < g.width(); x++) {
+      if (g.passage(x, z, Grid::EAST)) copy.carve(x, z, Grid::EAST);
+      if (g.passage(x, z, Grid::SOUTH)) copy.carve(x, z, Grid::SOUTH);
+    }
+  return saveMaze(out, copy, file.info(), file.distances()) ? 0 : 1;
+}
+
+int main(int argc, char** argv) {
+  if (argc < 3) return usage();
+  string command = argv[1];
+  if (command == "generate") return generate(argc, argv);
+  if (command == "info") return info(argv[2]);
+  if (command == "verify") return verify(argv[2]);
+  if (command == "export") return exportText(argv[2]);
+  if (command == "import" && argc > 3) return importText(argv[2], argv[3]);
+  if (command == "relayout" && argc > 4) return relayout(argv[2], argv[3], argv[4]);
+  return usage();
+}
@@ -0,0 +1,42 @@
+#ifndef ARENA_H
+#define ARENA_H
+
+#include <stdlib.h>
+
+//Bump allocator for data that lives exactly as long as one level.
+//arena_reset() drops everything at once; the memory is kept and handed out
+//again, so rebuilding a level of the same size or smaller allocates nothing.
+typedef struct {
+	unsigned char *base;
+	size_t capacity, used;
+} Arena;
+
+#define ARENA_ALIGN 16
+
+void arena_reset( Arena *a ) {
+	a->used = 0;
+}
+
+//Returns NULL if out of memory. The block can only grow while the arena is
+//empty, earlier allocations stay where they are
+void *arena_alloc( Arena *a, size_t size ) {
+	size = ( size + ARENA_ALIGN - 1 ) & ~(size_t)( ARENA_ALIGN - 1 );
+	if ( a->used + size > a->capacity ) {
+		if ( a->used != 0 ) return NULL;
+		free( a->base );
+		a->base = (unsigned char*)malloc( size );
+		a->capacity = a->base ? size : 0;
+		if ( a->base == NULL ) return NULL;
+	}
+	void *p = a->base + a->used;
+	a->used += size;
+	return p;
+}
+
+void arena_free( Arena *a ) {
+	free( a->base );
+	a->base = NULL;
+	a->capacity = a->used = 0;
+}
+
+#endif
@@ -0,0 +1,63 @@
+#ifndef COLLISION_H
+#define COLLISION_H
+
+#include <iostream>
+#include <cmath>
+
+#include "maze.h"
+#include "CircleSweep.h"
+#include "RayCast.h"
+
+using namespace std;
+
+float cameraMoveSpeed = 0.1f;
+
+//Direction vector of camera and position vector of camera
+float lx=0.0f,lz=-1.0f, ly=0;
+float x=2 ,z=2, y = 0;
+
+//Wall test for worlds that don't fit in maze[][], set by the chunked world
+bool (*wallLookup)(int bx, int bz) = NULL;
+
+//Player is a circle this wide (in world units, a block is 2) that slides
+//along the walls, see CircleSweep.h
+#define PLAYER_RADIUS 0.5f
+
+//Block b covers world coordinates 2b-1 to 2b+1
+const SweepGrid blockGrid(2, 1);
+
+bool isWall(int bx, int bz) {
+	return wallLookup ? wallLookup(bx, bz) : occupancy.wall(bx, bz);
+}
+
+//True if the player overlaps a wall, which computePos never lets happen
+bool checkCollision() {
+	return circleHitsWall(x, z, PLAYER_RADIUS, blockGrid, isWall);
+}
+
+//True if nothing but ground lies on the line between two points (world coordinates)
+bool canSee(float x1, float z1, float x2, float z2) {
+	//Block b covers world 2b-1 to 2b+1, so block coordinates are (world+1)/2
+	return lineOfSight(blockRays(isWall), (x1+1)/2, (z1+1)/2, (x2+1)/2, (z2+1)/2);
+}
+
+//Function to compute X and Z position
+void computePos(float deltaX, float deltaZ) {
+	cout<<"Original camera coordinates: "<<x<<","<<z<<"\n";
+
+	float rightZ = -lz;
+	float rightX = lx;
+
+	//Front and back movement plus left and right movement, swept in one go
+	float dx = (deltaX * lx + deltaZ * rightZ) * cameraMoveSpeed;
+	float dz = (deltaX * lz + deltaZ * rightX) * cameraMoveSpeed;
+
+	//Walls stop only the part of the move that runs into them, the rest slides
+	if (sweepCircle(&x, &z, dx, dz, PLAYER_RADIUS, blockGrid, isWall))
+		cout<<"Collision detected\n";
+	cout<<"New camera coordinates: "<<x<<","<<z<<"\n";
+
+	cout<<"\n";
+}
+
+#endif
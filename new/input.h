@@ -0,0 +1,80 @@
+#ifndef INPUT_H
+#define INPUT_H
+
+#include <stdlib.h>
+#include <atomic>
+
+//Pointer motion gathered between simulation ticks. The GLUT motion callback
+//adds every event's relative motion on the main thread; the simulation takes
+//the sum once per tick, so a 1000 Hz mouse costs one turn per tick instead
+//of one per event.
+typedef struct {
+	std::atomic<int> dx, dy;
+	int lastX, lastY; //Pointer position of the previous event, main thread only
+	int warpWait; //Events left to wait for the event of the last warp, 0 if none
+	int warpX, warpY; //Where the pointer was warped to
+} MouseInput;
+
+//Turn per pixel of pointer motion, in radians
+#define MOUSE_SENSITIVITY 0.01f
+
+//The pointer is moved back to the centre once it gets this close to the
+//window edge, as a fraction of the window size
+#define MOUSE_WARP_MARGIN 0.25f
+
+//A warp's event may never come, or come merged with real motion somewhere
+//near the centre; after this many other events the warp is given up on
+#define MOUSE_WARP_EVENTS 2
+
+void mouse_reset( MouseInput *m, int x, int y ) {
+	m->dx = 0;
+	m->dy = 0;
+	m->lastX = x;
+	m->lastY = y;
+	m->warpWait = 0;
+}
+
+//Motion callback: add the motion since the previous event. Events already
+//queued when a warp is asked for still come from the pointer's real path and
+//count. The warp's own event is the first one closer to the warp target than
+//to the previous position: it only moves lastX/lastY there, so the jump back
+//adds no turn. If none turns up within MOUSE_WARP_EVENTS events the warp was
+//lost and the pointer may be warped again. Returns true if the pointer must
+//be warped to the centre
+bool mouse_move( MouseInput *m, int x, int y, int width, int height ) {
+	if ( m->warpWait ) {
+		int toWarp = abs( x - m->warpX ) + abs( y - m->warpY );
+		int toLast = abs( x - m->lastX ) + abs( y - m->lastY );
+		if ( toWarp < toLast ) {
+			m->warpWait = 0;
+			m->lastX = x;
+			m->lastY = y;
+			return false;
+		}
+		m->warpWait--;
+	}
+	int dx = x - m->lastX, dy = y - m->lastY;
+	if ( dx ) m->dx.fetch_add( dx, std::memory_order_relaxed );
+	if ( dy ) m->dy.fetch_add( dy, std::memory_order_relaxed );
+	m->lastX = x;
+	m->lastY = y;
+	if ( m->warpWait ) return false; //one warp at a time
+	int marginX = (int)( width * MOUSE_WARP_MARGIN ), marginY = (int)( height * MOUSE_WARP_MARGIN );
+	if ( x < marginX || x >= width - marginX || y < marginY || y >= height - marginY ) {
+		m->warpWait = MOUSE_WARP_EVENTS;
+		m->warpX = width / 2;
+		m->warpY = height / 2;
+		return true;
+	}
+	return false;
+}
+
+//Simulation thread: take everything gathered since the last call, false if
+//the pointer didn't move
+bool mouse_take( MouseInput *m, int *dx, int *dy ) {
+	*dx = m->dx.exchange( 0, std::memory_order_relaxed );
+	*dy = m->dy.exchange( 0, std::memory_order_relaxed );
+	return *dx || *dy;
+}
+
+#endif
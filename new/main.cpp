@@ -9,18 +9,32 @@
 #include <cmath>
 #include <math.h>
 #include <string.h>
+#include <thread>
+#include <atomic>
 
+#define GL_GLEXT_PROTOTYPES //Vertex buffers for the chunked world
 #include <GL/glut.h>
 
 #include "texture.h"
+#include "replay.h"
+#include "maze.h"
+#include "collision.h"
+#include "world.h"
+#include "SpscQueue.h"
+#include "input.h"
+#include "SpatialHash.h"
+#include "minimap.h"
+#include "TripleBuffer.h"
 
 using namespace std;
 
-#define MAZE_SIZE 13
 #define GAME_START 0
 #define GAME_ON 1
 #define GAME_WON 2
 
+//Fixed simulation step, movement is applied once per tick
+#define SIM_TICK_MS 16
+
 // Game state
 int gameState = 0;
 
@@ -31,29 +45,20 @@ int SizeY=600;
 
 // Mouse Origin
 int xOrigin=SizeX/2;
-int yOrigin=SizeX/2;
-
-float cameraMoveSpeed = 0.1f;
+int yOrigin=SizeY/2;
 
 //Booleans for tracking map states
 bool mapMode = false;
 bool win = false;
 
-//Angle of rotation, direction vector of camera and position vector of camera
+//Angle of rotation (radians) and camera tilt, position and direction are in collision.h
 float angle=0.0f;
-float lx=0.0f,lz=-1.0f, ly=0;
 float tilt = 0;
-float x=2 ,z=2, y = 0;
 
 float origTilt;
 float origLy;
 
-//Angle for blip
-float turnAngle = 0;
-
 //Deltas for camera movement
-float deltaAngle = 0.0f;
-float deltaAngleY = 0.0f;
 float deltaX = 0;
 float deltaZ = 0;
 
@@ -63,6 +68,37 @@ unsigned int g_start = 2;
 
 unsigned int g_bitmap_text_handle = 0;
 
+//Everything the renderer needs from one simulation tick
+struct GameSnapshot {
+	unsigned int tick;
+	int gameState;
+	bool mapMode;
+	float x, z, y, lx, lz, tilt, angle;
+};
+
+//Simulation clock and input recording/replay. The game state above is owned
+//by the simulation thread; GLUT callbacks only push to inputQueue and the
+//renderer only reads snapshots.
+unsigned long long mazeSeed = 0;
+unsigned char worldFlags = 0;  //REPLAY_FLAG_*, recorded with the session
+unsigned int simTick = 0;
+double sessionStart = 0;
+bool headless = false;   //no window, simulation only (fast replay)
+bool replaying = false;
+Replay replay;
+size_t replayPos = 0;
+int framesDrawn = 0;
+SpscQueue<ReplayEvent, 1024> inputQueue; //input received since the last tick
+MouseInput mouseInput; //pointer motion received since the last tick
+
+//Things the player picks up by walking into them, only the diamond so far
+EntitySet pickups;
+SpatialHash pickupHash(4); //one maze cell, 2 blocks, per hash cell
+TripleBuffer<GameSnapshot> snapshots;
+std::thread simThread;
+std::atomic<bool> simRunning(false);
+std::atomic<bool> replayFinished(false);
+
 //Datastructures for lights and material properties
 struct materials_t {
 	float ambient[4];
@@ -190,165 +226,6 @@ void draw_text(const char* text) {
 	glCallLists(int(strlen(text)), GL_UNSIGNED_BYTE, text);
 }
 
-//Array for map layout. 0 for wall cubes and 2 for ground
-typedef struct {
-	int x, y; //Node position - little waste of memory, but it allows faster generation
-	void *parent; //Pointer to parent node
-	char c; //Character to be displayed
-	char dirs; //Directions that still haven't been explored
-} Node;
-
-Node *nodes; //Nodes array
-const int width=MAZE_SIZE, height=MAZE_SIZE; //Maze dimensions
-int maze[width][height];
-int diamondx, diamondz;
-
-int init_maze( ) {
-	int i, j;
-	Node *n;
-
-	diamondx = 2*(1 + 2*(rand()%(width/2))); // *2 for world coordinate
-	diamondz = 2*(1 + 2*(rand()%(height/2)));
-
-	//Allocate memory for maze
-	nodes = (Node*)calloc( width * height, sizeof( Node ) );
-	if ( nodes == NULL ) return 1;
-
-	//Setup crucial nodes
-	for ( i = 0; i < width; i++ ) {
-		for ( j = 0; j < height; j++ ) {
-			n = nodes + i + j * width;
-			if ( i * j % 2 ) {
-				n->x = i;
-				n->y = j;
-				n->dirs = 15; //Assume that all directions can be explored (4 youngest bits set)
-				n->c = ' ';
-			}
-			else n->c = '#'; //Add walls between nodes
-		}
-	}
-	return 0;
-}
-
-Node *link_node( Node *n ) {
-	//Connects node to random neighbor (if possible) and returns
-	//address of next node that should be visited
-	int x, y;
-	char dir;
-	Node *dest;
-
-	//Nothing can be done if null pointer is given - return
-	if ( n == NULL ) return NULL;
-
-	//While there are directions still unexplored
-	while ( n->dirs ) {
-		//Randomly pick one direction
-		dir = ( 1 << ( rand( ) % 4 ) );
-
-		//If it has already been explored - try again
-		if ( ~n->dirs & dir ) continue;
-
-		//Mark direction as explored
-		n->dirs &= ~dir;
-
-		//Depending on chosen direction
-		switch ( dir ) {
-			//Check if it's possible to go right
-			case 1:
-				if ( n->x + 2 < width ) {
-					x = n->x + 2;
-					y = n->y;
-				}
-				else continue;
-				break;
-
-			//Check if it's possible to go down
-			case 2:
-				if ( n->y + 2 < height ) {
-					x = n->x;
-					y = n->y + 2;
-				}
-				else continue;
-				break;
-
-			//Check if it's possible to go left
-			case 4:
-				if ( n->x - 2 >= 0 ) {
-					x = n->x - 2;
-					y = n->y;
-				}
-				else continue;
-				break;
-
-			//Check if it's possible to go up
-			case 8:
-				if ( n->y - 2 >= 0 ) {
-					x = n->x;
-					y = n->y - 2;
-				}
-				else continue;
-				break;
-		}
-
-		//Get destination node into pointer (makes things a tiny bit faster)
-		dest = nodes + x + y * width;
-
-		//Make sure that destination node is not a wall
-		if ( dest->c == ' ' ) {
-			//If destination is a linked node already - abort
-			if ( dest->parent != NULL ) continue;
-
-			//Otherwise, adopt node
-			dest->parent = n;
-
-			//Remove wall between nodes
-			nodes[n->x + ( x - n->x ) / 2 + ( n->y + ( y - n->y ) / 2 ) * width].c = ' ';
-
-			//Return address of the child node
-			return dest;
-		}
-	}
-
-	//If nothing more can be done here - return parent's address
-	return (Node*)(n->parent);
-}
-
-void draw( ) {
-	//Outputs maze to terminal - nothing special
-	for ( int i = 0; i < height; i++ ) {
-		for ( int j = 0; j < width; j++ ) {
-			cout<<nodes[j + i * width].c;
-      if(nodes[j + i * width].c == '#') {
-        maze[i][j] = 0;
-      }
-      else {
-        maze[i][j] = 2;
-      }
-		}
-		cout<<"\n";
-	}
-}
-
-void mazeGen() {
-	Node *start, *last;
-	//Seed random generator
-	srand( time( NULL ) );
-
-	//Initialize maze
-	if ( init_maze( ) ) {
-		fprintf( stderr, "out of memory for maze!\n" );
-		exit( 1 );
-	}
-
-	//Setup start node
-	start = nodes + 1 + width;
-	start->parent = start;
-	last = start;
-	//Connect nodes until start node is reached and can't be left
-	while ( ( last = link_node( last ) ) != start );
-	draw();
-}
-
 //Function for window resize
 void reshape(int w, int h) {
 	SizeX=w;
@@ -453,78 +330,24 @@ void drawFloor(GLfloat x1, GLfloat x2, GLfloat z1, GLfloat z2) {
   glEnd();
 }
 
-//Trivial collision detection based on position of cubes in the map
-//Based on what is front, if close to the wall, return true
-bool checkCollision() {
-	float camWorldX = (x+lx)/2;
-	float camWorldZ = (z+lz)/2;
-
-	int truncX = static_cast<int>(camWorldX);
-	int truncZ = static_cast<int>(camWorldZ);
-
-	int roundedZ = round(camWorldZ);
-	int roundedX = round(camWorldX);
-
-	cout<<"camWorld: "<<camWorldX<<","<<camWorldZ<<"\n";
-	cout<<"trunc: "<<truncX<<","<<truncZ<<"\n";
-	cout<<"maze_value: "<<maze[roundedX][roundedZ]<<"\n\n";
-	if (maze[roundedX][roundedZ] == 0) {
-		// if (camWorldX > truncX+0.5 || truncZ > 1)
-		return true;
-		// else return false;
-	} else
-	 return false;
-}
-
-//Function to compute X and Z position
-void computePos(float deltaX, float deltaZ) {
-	// store the old camera coordinates
-	cout<<"Original camera coordinates: "<<x<<","<<z<<"\n";
-	float oldx = x;
-	float oldz = z;
-
-	//Front and back movement
-	x += deltaX * lx * cameraMoveSpeed;
-	z += deltaX * lz * cameraMoveSpeed;
-	// cout<<"After front and back movement: "<<x<<","<<z<<"\n";
-
-	float rightZ = -lz;
-	float rightX = lx;
-
-	//Left and right movement
-	x += deltaZ * rightZ * cameraMoveSpeed;
-	z += deltaZ * rightX * cameraMoveSpeed;
-	cout<<"New camera coordinates: "<<x<<","<<z<<"\n";
-
-	//Don't allow movement if collision is true
-	if (checkCollision ()) {
-		x = oldx;
-		z = oldz;
-		cout<<"Collision detected\n";
-	}
-
-	cout<<"\n";
-}
+//Advance the game by one fixed step, no rendering happens here
+void simulateTick() {
+	if (gameState == GAME_START) return;
 
-void gameProgressScreen() {
-	//Check if goal is reached
-	if (x > diamondx-1 && x < diamondx+1 && z > diamondz-1 && z < diamondz+1) {
+	//Check if goal is reached, the player touches the diamond
+	bool reached = false;
+	pickupHash.query(x, z, PLAYER_RADIUS, [&](uint32_t) { reached = true; });
+	if (reached) {
 		gameState = GAME_WON;
 		mapMode = true;
-		glutPostRedisplay();
 	}
 	//If there has been change in X and Z position, compute new position
 	if (deltaX || deltaZ) {
 		computePos(deltaX, deltaZ);
 	}
+	if (worldInfinite) world_update(x, z);
 	y = tilt+ly;
 
-	glClear(GL_COLOR_BUFFER_BIT|GL_DEPTH_BUFFER_BIT);
-	//Color for background
-	glClearColor(0.139, 0.134, 0.130, 1);
-	glMatrixMode(GL_MODELVIEW);
-	glLoadIdentity();
-
 	//Incremental zoomin and zoomout
 	if (mapMode) {
 		if ( tilt != 75)
@@ -537,24 +360,40 @@ void gameProgressScreen() {
 		tilt = 0;
 		y = tilt+ly;
 	}
+}
+
+void gameProgressScreen(const GameSnapshot &s) {
+	glClear(GL_COLOR_BUFFER_BIT|GL_DEPTH_BUFFER_BIT);
+	//Color for background
+	glClearColor(0.139, 0.134, 0.130, 1);
+
+	//Holding m shows the whole map, drawn from the cached minimap texture
+	//instead of the maze from above
+	if (s.mapMode && s.gameState == GAME_ON && !worldInfinite) {
+		int size = (SizeX < SizeY ? SizeX : SizeY) - 40;
+		minimap_draw(s.x, s.z, s.lx, s.lz, (SizeX - size) / 2, (SizeY - size) / 2, size, SizeX, SizeY);
+		return;
+	}
+	glMatrixMode(GL_MODELVIEW);
+	glLoadIdentity();
 
 	//Camera vector
-	gluLookAt(x, tilt, z, // eye position
-			  x+lx, y, z+lz, // reference point
+	gluLookAt(s.x, s.tilt, s.z, // eye position
+			  s.x+s.lx, s.y, s.z+s.lz, // reference point
 			  0, 1, 0);  // up vector
 
 	//Light for triangle blip
 	glDisable(GL_LIGHTING);
 	glPushMatrix();
 		glPointSize(5.0f);
-		set_light(light_1, x+lx, z+lz);
+		set_light(light_1, s.x+s.lx, s.z+s.lz);
 	glPopMatrix();
 	glEnable(GL_LIGHTING);
 
 	//Drawing the blip for camera position
 	glPushMatrix();
-		glTranslatef(x+lx, -0.60f, z+lz);
-		glRotatef(deltaAngle, 0, 1, 0);
+		glTranslatef(s.x+s.lx, -0.60f, s.z+s.lz);
+		glRotatef(-s.angle * 180 / M_PI, 0, 1, 0);
 		glScalef(0.5,1.0,0.5);
 		glBegin(GL_POLYGON);
 	 		glNormal3f (0,1, 0);
@@ -568,7 +407,7 @@ void gameProgressScreen() {
 	glPopMatrix();
 
 	//Changes to be made when goal is reached
-	if (gameState == GAME_ON) {
+	if (s.gameState == GAME_ON) {
 		//Lighting for text
 		glDisable(GL_LIGHTING);
 		glPushMatrix();
@@ -578,7 +417,7 @@ void gameProgressScreen() {
 		glPopMatrix();
 		glEnable(GL_LIGHTING);
 	}
-	else if(gameState == GAME_WON) {
+	else if(s.gameState == GAME_WON) {
 		//Light for text
 		glPushMatrix();
 			glPointSize(5.0f);
@@ -609,6 +448,13 @@ void gameProgressScreen() {
 		glutSolidOctahedron();
 	glPopMatrix ();
 
+	//The chunked world brings its own geometry, streamed in around the player
+	if (worldInfinite) {
+		world_upload(CHUNK_UPLOADS_PER_FRAME);
+		world_draw(g_wall, g_ground);
+		return;
+	}
+
 	float stary;
 
 	for(int i = 0; i < MAZE_SIZE; i++) {
@@ -657,23 +503,26 @@ void gameProgressScreen() {
 			}
 		}
 	}
+
+	//Minimap in the top right corner
+	minimap_draw(s.x, s.z, s.lx, s.lz, SizeX - MINIMAP_CORNER - 10, 10, MINIMAP_CORNER, SizeX, SizeY);
 }
 
-void gameBeginScreen(){
+void gameBeginScreen(const GameSnapshot &s){
 	glClear(GL_COLOR_BUFFER_BIT|GL_DEPTH_BUFFER_BIT);
 	glClearColor(0.139, 0.134, 0.130, 1);
 	glMatrixMode(GL_MODELVIEW);
 	glLoadIdentity();
 	//Camera vector
-	gluLookAt(x, tilt, z, // eye position
-			  x+lx, y, z+lz, // reference point
+	gluLookAt(s.x, s.tilt, s.z, // eye position
+			  s.x+s.lx, s.y, s.z+s.lz, // reference point
 			  0, 1, 0);  // up vector
 
 	//Light for triangle blip
 	glDisable(GL_LIGHTING);
 	glPushMatrix();
 		glPointSize(5.0f);
-		set_light(light_3, x+lx, z+lz);
+		set_light(light_3, s.x+s.lx, s.z+s.lz);
 	glPopMatrix();
 	glEnable(GL_LIGHTING);
 
@@ -699,26 +548,38 @@ void gameBeginScreen(){
 	glPopMatrix();
 }
 
-void display(){
-	switch(gameState){
-		case GAME_START:
-			gameBeginScreen();
-			break;
-		case GAME_ON:
-			gameProgressScreen();
-			break;
-		case GAME_WON:
-			gameProgressScreen();
-			break;
-		default:
-			break;
-	}
-	glFlush ();
-  glutSwapBuffers();
+double wallSeconds() {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+//Milliseconds since the session started, simulated time when headless
+unsigned int sessionTime() {
+	if (headless) return simTick * SIM_TICK_MS;
+	return (unsigned int)((wallSeconds() - sessionStart) * 1000);
+}
+
+//Close the recording on any exit path (q, escape, menu)
+void finishRecording() {
+	replay_end_record(simTick, simTick * SIM_TICK_MS);
+}
+
+//End of the recorded stream, print the run statistics
+void reportReplay() {
+	double elapsed = wallSeconds() - sessionStart;
+	printf("replay finished: %u ticks (%.2f s recorded) in %.3f s\n",
+			simTick, simTick * SIM_TICK_MS / 1000.0, elapsed);
+	if (headless)
+		printf("simulation rate: %.0f ticks/s\n", simTick / (elapsed > 0 ? elapsed : 1e-9));
+	else
+		printf("frames drawn: %d, average frame time %.3f ms\n",
+				framesDrawn, framesDrawn ? 1000.0 * elapsed / framesDrawn : 0.0);
+	printf("final state: %d at (%f, %f) looking (%f, %f)\n", gameState, x, z, lx, lz);
 }
 
 //Keyboard press handler
-void pressKey(unsigned char key, int xx, int yy) {
+void handleKeyDown(unsigned char key) {
 	switch (key) {
 		//Change y to get a top down view and store current y and eye y
 		//to revert back to it when key is released
@@ -731,7 +592,7 @@ void pressKey(unsigned char key, int xx, int yy) {
 			gameState = GAME_ON;
 			break;
 		case 'q' :
-			glutDestroyWindow(mainWindow);
+			if (!headless) glutDestroyWindow(mainWindow);
 			exit(0);
 			break;
 		case 27:
@@ -739,7 +600,7 @@ void pressKey(unsigned char key, int xx, int yy) {
 	}
 }
 
-void pressSpecialKey(int key, int xx, int yy) {
+void handleSpecialKeyDown(int key) {
 	switch (key) {
 		case GLUT_KEY_UP : deltaX = 0.5f; break;
 		case GLUT_KEY_DOWN : deltaX = -0.5f; break;
@@ -749,14 +610,14 @@ void pressSpecialKey(int key, int xx, int yy) {
 }
 
 //Keyboard press release handler
-void releaseKey(unsigned char key, int x, int y) {
+void handleKeyUp(unsigned char key) {
 	switch (key) {
 		case 'm': mapMode = false;
 			break;
 		}
 }
 
-void releaseSpecialKey(int key, int x, int y) {
+void handleSpecialKeyUp(int key) {
 	switch (key) {
 		case GLUT_KEY_UP : deltaX = 0.0f; break;
 		case GLUT_KEY_DOWN : deltaX = 0.0f; break;
@@ -765,41 +626,177 @@ void releaseSpecialKey(int key, int x, int y) {
 	}
 }
 
-//Passive mouse movement callback
-void mouseMove(int xx, int yy) {
-	// before modifying, save the global variables, we may need them later to revert the movement
-	float t = turnAngle;
-	float dAngle = deltaAngle, dAngleY = deltaAngleY;
-	int lx1=lx,ly1=ly,lz1=lz;
-
-	//turnAngle calculated for triangle blip rotation
-	turnAngle = -1 * (xx - xOrigin);
-	if (turnAngle>0) {
-		turnAngle = turnAngle + 10;
-	} else if (turnAngle<0)
-		turnAngle = turnAngle - 10;
-	else
-		turnAngle = 0;
-
-	//Change in x and y values due to mouse movement
-	deltaAngle = (xx - xOrigin) * 0.01f;
-	deltaAngleY = (yy - yOrigin) * 0.00f;
-
-	//Calculating new camera direction
-	lx = sin(angle + deltaAngle);
-	lz = -cos(angle + deltaAngle);
-	ly =  -sin(deltaAngleY);
-
-	if(checkCollision()){
-		// there is collision, restore global variables
-		lx=lx1; ly=ly1; lz=lz1;
-		turnAngle = t;
-		deltaAngle = dAngle;
-		deltaAngleY = dAngleY;
-		cout<<"Collision detected\n";
+//Mouse movement, (dx, dy) is the pointer motion over one tick
+void handleMouseMove(int dx, int dy) {
+	angle += dx * MOUSE_SENSITIVITY;
+
+	//Calculating new camera direction, turning never collides
+	lx = sin(angle);
+	lz = -cos(angle);
+}
+
+void applyInput(const ReplayEvent &ev) {
+	switch (ev.type) {
+		case EV_KEY_DOWN: handleKeyDown(ev.a); break;
+		case EV_KEY_UP: handleKeyUp(ev.a); break;
+		case EV_SPECIAL_DOWN: handleSpecialKeyDown(ev.a); break;
+		case EV_SPECIAL_UP: handleSpecialKeyUp(ev.a); break;
+		case EV_MOUSE_MOVE: handleMouseMove(ev.a, ev.b); break;
+	}
+}
+
+//Apply the input for this tick (live or recorded) and step the game once
+void runTick() {
+	ReplayEvent ev;
+	if (replaying) {
+		while (replayPos < replay.events.size() && replay.events[replayPos].tick == simTick) {
+			ev = replay.events[replayPos++];
+			if (ev.type == EV_END) {
+				replayFinished = true;
+				return;
+			}
+			applyInput(ev);
+		}
+	} else {
+		while (inputQueue.pop(ev)) {
+			ev.tick = simTick;
+			replay_record(ev);
+			applyInput(ev);
+		}
+		//All pointer motion since the last tick as one event
+		int dx, dy;
+		if (mouse_take(&mouseInput, &dx, &dy)) {
+			ReplayEvent move = {simTick, sessionTime(), EV_MOUSE_MOVE, dx, dy};
+			replay_record(move);
+			applyInput(move);
+		}
+	}
+	simulateTick();
+	simTick++;
+}
+
+void publishSnapshot() {
+	GameSnapshot &s = snapshots.writeBuffer();
+	s.tick = simTick;
+	s.gameState = gameState;
+	s.mapMode = mapMode;
+	s.x = x; s.z = z; s.y = y;
+	s.lx = lx; s.lz = lz;
+	s.tilt = tilt;
+	s.angle = angle;
+	snapshots.publish();
+}
+
+//Simulation thread: runs the ticks that are due, publishes the result and
+//sleeps until the next tick, independent of how long frames take to draw
+void simulationLoop() {
+	while (simRunning && !replayFinished) {
+		unsigned int now = sessionTime();
+		while (!replayFinished && (simTick + 1) * SIM_TICK_MS <= now)
+			runTick();
+		publishSnapshot();
+		unsigned int next = (simTick + 1) * SIM_TICK_MS;
+		now = sessionTime();
+		if (next > now) usleep((next - now) * 1000);
+	}
+}
+
+void stopSimulation() {
+	simRunning = false;
+	if (!simThread.joinable()) return;
+	if (simThread.get_id() == std::this_thread::get_id()) simThread.detach();
+	else simThread.join();
+}
+
+void startSimulation() {
+	sessionStart = wallSeconds();
+	publishSnapshot();
+	simRunning = true;
+	simThread = std::thread(simulationLoop);
+	atexit(stopSimulation);
+}
+
+//Put the pickups of a new level into their hash, after the diamond is placed
+void placePickups() {
+	pickups.clear();
+	pickups.add(diamondx, diamondz, 0.5f);
+	pickupHash.build(pickups);
+}
+
+//Replay as fast as possible without a window, for simulation soak tests
+int runFastReplay() {
+	mazeGen(mazeSeed);
+	if (worldFlags & REPLAY_FLAG_INFINITE) world_init(mazeSeed);
+	placePickups();
+	//Per-tick debug output would dominate the run time, silence it
+	cout.setstate(ios::badbit);
+	sessionStart = wallSeconds();
+	while (!replayFinished)
+		runTick();
+	reportReplay();
+	return 0;
+}
+
+void display(){
+	if (replayFinished) {
+		stopSimulation();
+		reportReplay();
+		exit(0);
+	}
+	const GameSnapshot &s = snapshots.read();
+	switch(s.gameState){
+		case GAME_START:
+			gameBeginScreen(s);
+			break;
+		case GAME_ON:
+			if (!worldInfinite) minimap_update(s.x, s.z);
+			gameProgressScreen(s);
+			break;
+		case GAME_WON:
+			if (!worldInfinite) minimap_update(s.x, s.z);
+			gameProgressScreen(s);
+			break;
+		default:
+			break;
 	}
+	glFlush ();
+  glutSwapBuffers();
+	framesDrawn++;
+}
 
-	glutSetWindow(mainWindow);
+//Input callbacks only queue the event, it is applied on the next tick
+void postInput(unsigned char type, int a, int b) {
+	if (replaying) return; //the recording drives the game
+	ReplayEvent ev = {0, sessionTime(), type, a, b};
+	if (!inputQueue.push(ev))
+		fprintf(stderr, "input queue full, event dropped\n");
+}
+
+void pressKey(unsigned char key, int xx, int yy) {
+	//Quitting is never deferred, not even while a replay is running
+	if (key == 'q' || key == 27) handleKeyDown(key);
+	else postInput(EV_KEY_DOWN, key, 0);
+}
+
+void pressSpecialKey(int key, int xx, int yy) {
+	postInput(EV_SPECIAL_DOWN, key, 0);
+}
+
+void releaseKey(unsigned char key, int x, int y) {
+	postInput(EV_KEY_UP, key, 0);
+}
+
+void releaseSpecialKey(int key, int x, int y) {
+	postInput(EV_SPECIAL_UP, key, 0);
+}
+
+//Passive mouse movement callback, only adds up the motion; it is applied
+//once per tick. The pointer is kept away from the window edges so it never
+//runs out of room
+void mouseMove(int xx, int yy) {
+	if (replaying) return; //the recording drives the game
+	if (mouse_move(&mouseInput, xx, yy, SizeX, SizeY))
+		glutWarpPointer(xOrigin, yOrigin);
 }
 
 //Loading textures
@@ -815,10 +812,50 @@ void init() {
 	glEnable(GL_DEPTH_TEST);
 	glShadeModel(GL_SMOOTH);
 	set_material (materialM);
-	mazeGen();
+	mazeGen(mazeSeed);
+	if (worldFlags & REPLAY_FLAG_INFINITE) {
+		world_init(mazeSeed);
+		world_start_workers();
+	}
+	placePickups();
+	minimap_init();
+}
+
+void usage(const char *prog) {
+	fprintf(stderr, "usage: %s [--seed N] [--infinite] [--record FILE | --replay FILE [--fast]]\n", prog);
+	exit(1);
 }
 
 int main(int argc, char **argv) {
+	//Command line: maze seed and input recording/replay
+	const char *recordPath = NULL, *replayPath = NULL;
+	bool fast = false;
+	mazeSeed = time(NULL);
+	for (int i = 1; i < argc; i++) {
+		if (!strcmp(argv[i], "--seed") && i + 1 < argc) mazeSeed = strtoull(argv[++i], NULL, 10);
+		else if (!strcmp(argv[i], "--record") && i + 1 < argc) recordPath = argv[++i];
+		else if (!strcmp(argv[i], "--replay") && i + 1 < argc) replayPath = argv[++i];
+		else if (!strcmp(argv[i], "--fast")) fast = true;
+		else if (!strcmp(argv[i], "--infinite")) worldFlags |= REPLAY_FLAG_INFINITE;
+		else if (argv[i][0] == '-' && argv[i][1] == '-') usage(argv[0]);
+	}
+	if (replayPath) {
+		if (!replay_load(replayPath, &replay)) return 1;
+		mazeSeed = replay.seed;
+		worldFlags = replay.flags;
+		replaying = true;
+		if (fast) {
+			headless = true;
+			return runFastReplay();
+		}
+	} else if (fast) {
+		usage(argv[0]);
+	} else if (recordPath) {
+		if (!replay_begin_record(recordPath, mazeSeed, worldFlags)) return 1;
+		atexit(finishRecording);
+	}
+	printf("maze seed: %llu\n", mazeSeed);
+
 	// init GLUT and create window
 	glutInit(&argc, argv);
 	glutInitDisplayMode(GLUT_DEPTH | GLUT_DOUBLE | GLUT_RGBA);
@@ -842,7 +879,9 @@ int main(int argc, char **argv) {
 
 	//Mouse Callbacks
 	glutPassiveMotionFunc(mouseMove);
-	glutWarpPointer(SizeX/2,SizeY/2);
+	glutSetCursor(GLUT_CURSOR_NONE);
+	mouse_reset(&mouseInput, xOrigin, yOrigin);
+	glutWarpPointer(xOrigin, yOrigin);
 
 	glEnable(GL_DEPTH_TEST);
 
@@ -854,6 +893,7 @@ int main(int argc, char **argv) {
 	init();
 	g_bitmap_text_handle = make_bitmap_text();
 	createGLUTMenus ();
+	startSimulation();
 	// enter GLUT event processing cycle
 	glutMainLoop();
 	return 0;
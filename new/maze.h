@@ -0,0 +1,187 @@
+#ifndef MAZE_H
+#define MAZE_H
+
+#include <iostream>
+#include <stdio.h>
+#include <stdlib.h>
+#include "Random.h"
+#include "DistanceField.h"
+#include "arena.h"
+#include "BlockMaze.h"
+#include "OccupancyGrid.h"
+
+#ifndef MAZE_SIZE
+#define MAZE_SIZE 13
+#endif
+
+using namespace std;
+
+//One byte per node, so even a 10000 x 10000 node maze fits in 100 MB:
+//bits 0-3 directions that still haven't been explored (1 right, 2 down, 4 left, 8 up)
+//bit 4 node is ground, not a wall
+//bit 5 node has been linked into the maze
+//bits 6-7 way back to the parent, 0 right, 1 down, 2 left, 3 up
+typedef unsigned char Node;
+
+#define NODE_DIRS 15
+#define NODE_OPEN 16
+#define NODE_LINKED 32
+#define NODE_PARENT_SHIFT 6
+
+Node *nodes = NULL; //Nodes array, lives in mazeArena
+Arena mazeArena = { NULL, 0, 0 }; //Reset for every maze, so regenerating doesn't allocate
+int rootNode; //Index of the node the walk starts and ends on
+int width=MAZE_SIZE, height=MAZE_SIZE; //Maze dimensions, at most MAZE_SIZE when drawn into maze[][]
+//Map layout, maze[x][z] is 0 for wall cubes and 2 for ground
+FixedMaze<MAZE_SIZE, MAZE_SIZE> maze;
+//The walls of maze[][] one bit each, what collision reads
+OccupancyGrid occupancy;
+int diamondx, diamondz;
+Random mazeRandom; //Generator for the maze layout, seeded by mazeGen
+
+int init_maze( ) {
+	int i, j;
+
+	//Take memory for maze from the arena, dropping the previous one
+	arena_reset( &mazeArena );
+	nodes = (Node*)arena_alloc( &mazeArena, width * height );
+	if ( nodes == NULL ) return 1;
+
+	//Setup crucial nodes
+	for ( j = 0; j < height; j++ ) {
+		for ( i = 0; i < width; i++ ) {
+			if ( i * j % 2 ) nodes[i + j * width] = NODE_OPEN | NODE_DIRS; //Assume that all directions can be explored
+			else nodes[i + j * width] = 0; //Add walls between nodes
+		}
+	}
+	return 0;
+}
+
+//Make (x, y) the node the walk starts from and returns to
+void set_root( int x, int y ) {
+	rootNode = x + y * width;
+	nodes[rootNode] |= NODE_LINKED;
+}
+
+//Steps between nodes, in the order of the direction bits
+const int node_dx[4] = { 2, 0, -2, 0 };
+const int node_dy[4] = { 0, 2, 0, -2 };
+
+bool link_node( int *x, int *y ) {
+	//Connects node (*x, *y) to random neighbor (if possible) and moves (*x, *y)
+	//to the node that should be visited next, returns false once the root is done
+	Node *n = nodes + *x + *y * width;
+	int k, dx, dy;
+	char dir;
+	Node *dest;
+
+	//While there are directions still unexplored
+	while ( *n & NODE_DIRS ) {
+		//Randomly pick one of the directions still unexplored
+		dir = mazeRandom.pickBit( *n & NODE_DIRS );
+
+		//Mark direction as explored
+		*n &= ~dir;
+
+		//Check if it's possible to go that way
+		k = __builtin_ctz( dir );
+		dx = *x + node_dx[k];
+		dy = *y + node_dy[k];
+		if ( dx < 0 || dx >= width || dy < 0 || dy >= height ) continue;
+
+		//Get destination node into pointer (makes things a tiny bit faster)
+		dest = nodes + dx + dy * width;
+
+		//Make sure that destination node is not a wall, and not a linked node already
+		if ( ( *dest & ( NODE_OPEN | NODE_LINKED ) ) != NODE_OPEN ) continue;
+
+		//Otherwise, adopt node, remembering the way back
+		*dest |= NODE_LINKED | ( ( k ^ 2 ) << NODE_PARENT_SHIFT );
+
+		//Remove wall between nodes
+		nodes[( *x + dx ) / 2 + ( *y + dy ) / 2 * width] |= NODE_OPEN;
+
+		//Continue from the child node
+		*x = dx;
+		*y = dy;
+		return true;
+	}
+
+	//If nothing more can be done here - go back to the parent
+	if ( n == nodes + rootNode ) return false;
+	k = *n >> NODE_PARENT_SHIFT;
+	*x += node_dx[k];
+	*y += node_dy[k];
+	return true;
+}
+
+void draw( ) {
+	//Outputs maze to terminal - nothing special
+	for ( int i = 0; i < height; i++ ) {
+		for ( int j = 0; j < width; j++ ) {
+			cout<<( nodes[j + i * width] & NODE_OPEN ? ' ' : '#' );
+      if(!( nodes[j + i * width] & NODE_OPEN )) {
+        maze[i][j] = 0;
+      }
+      else {
+        maze[i][j] = 2;
+      }
+		}
+		cout<<"\n";
+	}
+	occupancy.assign(maze);
+}
+
+//Generate a w x h node maze without drawing it
+void generateNodes( int w, int h ) {
+	int x = 1, y = 1;
+	width = w;
+	height = h;
+
+	//Initialize maze
+	if ( init_maze( ) ) {
+		fprintf( stderr, "out of memory for maze!\n" );
+		exit( 1 );
+	}
+
+	//Setup start node
+	set_root( x, y );
+	//Connect nodes until start node is reached and can't be left
+	while ( link_node( &x, &y ) );
+}
+
+//Put the diamond on the cell furthest from the start, walking distance
+void placeDiamond( ) {
+	//Cells are the odd nodes, a cell's x runs along node rows like world x does.
+	//Both are kept from level to level, so a new maze of the same size allocates nothing
+	static Grid cells;
+	static DistanceField *field = NULL;
+	int cw = ( height - 1 ) / 2, ch = ( width - 1 ) / 2;
+	if ( field == NULL || cells.width() != cw || cells.height() != ch ) {
+		delete field;
+		cells = Grid( cw, ch );
+		field = new DistanceField( cells );
+	}
+	else cells.clear();
+	for ( int gx = 0; gx < cw; gx++ ) {
+		for ( int gz = 0; gz < ch; gz++ ) {
+			if ( gx + 1 < cw && nodes[2*gz+1 + (2*gx+2) * width] & NODE_OPEN ) cells.carve( gx, gz, Grid::EAST );
+			if ( gz + 1 < ch && nodes[2*gz+2 + (2*gx+1) * width] & NODE_OPEN ) cells.carve( gx, gz, Grid::SOUTH );
+		}
+	}
+	field->compute( 0, 0 ); //The player starts at world (2,2), cell (0,0)
+	int fx, fz;
+	field->farthest( &fx, &fz );
+	diamondx = 2*(1 + 2*fx); // *2 for world coordinate
+	diamondz = 2*(1 + 2*fz);
+}
+
+void mazeGen(unsigned long long seed) {
+	//Seed random generator, the same seed always gives the same maze
+	mazeRandom.setSeed( seed );
+	generateNodes( MAZE_SIZE, MAZE_SIZE );
+	placeDiamond();
+	draw();
+}
+
+#endif
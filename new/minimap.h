@@ -0,0 +1,142 @@
+#ifndef MINIMAP_GL_H
+#define MINIMAP_GL_H
+
+#include <limits.h>
+#include <vector>
+
+#ifndef GL_GLEXT_PROTOTYPES
+#define GL_GLEXT_PROTOTYPES
+#endif
+#include <GL/glut.h>
+
+#include "Minimap.h"
+#include "maze.h"
+
+//2D map of the blocks the player has seen. The map is drawn into a texture
+//only where something new was discovered, and every frame the texture is
+//put on screen with the player marker on top, so showing the map costs two
+//quads instead of the whole maze.
+
+#define MINIMAP_SIGHT 4 //How far the player sees, in blocks
+#define MINIMAP_TEXELS 1024 //Largest texture side, bigger mazes use a coarser pyramid level
+#define MINIMAP_CORNER 160 //Side of the corner map, in pixels
+
+Minimap minimap;
+GLuint minimapTexture = 0;
+int minimapLevel = 0; //Pyramid level held by the texture
+int minimapBlockX = INT_MIN, minimapBlockZ = INT_MIN; //Block the player last looked around from
+std::vector<uint32_t> minimapPixels;
+
+//Start a new map for the maze in occupancy, nothing discovered yet
+void minimap_init() {
+	minimap.assign(occupancy);
+	minimapLevel = minimap.levelFor(MINIMAP_TEXELS);
+	minimapBlockX = minimapBlockZ = INT_MIN;
+	if (minimapTexture) {
+		glDeleteTextures(1, &minimapTexture);
+		minimapTexture = 0;
+	}
+}
+
+//Render thread: discover what can be seen from world position (x, z) and
+//redraw the part of the texture that changed
+void minimap_update(float x, float z) {
+	//Block b covers world 2b-1 to 2b+1, so block coordinates are (world+1)/2
+	float bx = (x + 1) / 2, bz = (z + 1) / 2;
+	if ((int)floorf(bx) != minimapBlockX || (int)floorf(bz) != minimapBlockZ) {
+		minimapBlockX = (int)floorf(bx);
+		minimapBlockZ = (int)floorf(bz);
+		minimap.look(bx, bz, MINIMAP_SIGHT);
+	}
+
+	int level = minimapLevel, w = minimap.levelWidth(level), h = minimap.levelHeight(level);
+	if (!minimapTexture) {
+		glGenTextures(1, &minimapTexture);
+		glBindTexture(GL_TEXTURE_2D, minimapTexture);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+		glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, w, h, 0, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
+		glBindTexture(GL_TEXTURE_2D, 0);
+	}
+
+	//Only the texels covering the blocks that changed are drawn and uploaded
+	int x0, z0, x1, z1;
+	if (!minimap.takeChanges(&x0, &z0, &x1, &z1)) return;
+	x0 >>= level; z0 >>= level; x1 >>= level; z1 >>= level;
+	int rw = x1 - x0 + 1, rh = z1 - z0 + 1;
+	minimapPixels.resize((size_t)rw * rh);
+	minimap.render(level, x0, z0, rw, rh, &minimapPixels[0]);
+	glBindTexture(GL_TEXTURE_2D, minimapTexture);
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+	glTexSubImage2D(GL_TEXTURE_2D, 0, x0, z0, rw, rh, GL_RGBA, GL_UNSIGNED_BYTE, &minimapPixels[0]);
+	glBindTexture(GL_TEXTURE_2D, 0);
+}
+
+//Draw the map in a size x size square at (left, top) of a width x height
+//window, with the player at world (x, z) looking along (lx, lz)
+void minimap_draw(float x, float z, float lx, float lz, int left, int top, int size, int width, int height) {
+	if (!minimapTexture) return;
+	int w = minimap.width(), h = minimap.height();
+	float scale = (float)size / (w > h ? w : h); //Pixels per block
+	float right = left + w * scale, bottom = top + h * scale;
+
+	glMatrixMode(GL_PROJECTION);
+	glPushMatrix();
+	glLoadIdentity();
+	glOrtho(0, width, height, 0, -1, 1); //Pixels, y down the screen along +z
+	glMatrixMode(GL_MODELVIEW);
+	glPushMatrix();
+	glLoadIdentity();
+	glDisable(GL_LIGHTING);
+	glDisable(GL_DEPTH_TEST);
+	glEnable(GL_BLEND);
+	glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+
+	//Dark backing, so the undiscovered part reads as unknown
+	glColor4f(0, 0, 0, 0.5f);
+	glBegin(GL_QUADS);
+		glVertex2f(left, top);
+		glVertex2f(right, top);
+		glVertex2f(right, bottom);
+		glVertex2f(left, bottom);
+	glEnd();
+
+	//The discovered blocks
+	glEnable(GL_TEXTURE_2D);
+	glBindTexture(GL_TEXTURE_2D, minimapTexture);
+	glTexEnvf(GL_TEXTURE_ENV, GL_TEXTURE_ENV_MODE, GL_MODULATE);
+	//The texture may stop short of the map by part of a texel at coarse levels
+	float u = (float)w / (minimap.levelWidth(minimapLevel) << minimapLevel);
+	float v = (float)h / (minimap.levelHeight(minimapLevel) << minimapLevel);
+	glColor4f(1, 1, 1, 1);
+	glBegin(GL_QUADS);
+		glTexCoord2f(0, 0); glVertex2f(left, top);
+		glTexCoord2f(u, 0); glVertex2f(right, top);
+		glTexCoord2f(u, v); glVertex2f(right, bottom);
+		glTexCoord2f(0, v); glVertex2f(left, bottom);
+	glEnd();
+	glBindTexture(GL_TEXTURE_2D, 0);
+	glDisable(GL_TEXTURE_2D);
+
+	//Player marker, a triangle pointing the way the player looks
+	float px = left + (x + 1) / 2 * scale, pz = top + (z + 1) / 2 * scale;
+	float marker = scale * 0.6f > 4 ? scale * 0.6f : 4;
+	glColor3f(1, 0, 0);
+	glBegin(GL_TRIANGLES);
+		glVertex2f(px + lx * marker, pz + lz * marker);
+		glVertex2f(px - lx * marker * 0.6f - lz * marker * 0.6f, pz - lz * marker * 0.6f + lx * marker * 0.6f);
+		glVertex2f(px - lx * marker * 0.6f + lz * marker * 0.6f, pz - lz * marker * 0.6f - lx * marker * 0.6f);
+	glEnd();
+
+	glDisable(GL_BLEND);
+	glEnable(GL_DEPTH_TEST);
+	glEnable(GL_LIGHTING);
+	glPopMatrix();
+	glMatrixMode(GL_PROJECTION);
+	glPopMatrix();
+	glMatrixMode(GL_MODELVIEW);
+}
+
+#endif
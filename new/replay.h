@@ -0,0 +1,203 @@
+#ifndef REPLAY_H
+#define REPLAY_H
+
+#include <stdio.h>
+#include <string.h>
+#include <vector>
+
+// Compact binary recording of a play session.
+//
+// File layout (all multi-byte values little endian):
+//   "FDRP"            4 byte magic
+//   version           1 byte
+//   seed              8 bytes, the maze seed passed to mazeGen
+//   flags             1 byte, REPLAY_FLAG_* world options
+//   events...         until an EV_END record
+//
+// Every event is stored as
+//   type              1 byte
+//   tick delta        varint, simulation ticks since the previous event
+//   time delta        varint, milliseconds since the previous event
+//   payload           key: 1 byte, special key: varint,
+//                     mouse: two zigzag varints, pointer motion (dx, dy)
+//
+// Events are stamped with the simulation tick they were applied on, so a
+// replay applies them on exactly the same tick and reproduces the session.
+
+//Version 2: mazes are generated with Random.h, a version 1 seed builds a different maze
+//Version 3: flags byte after the seed
+//Version 4: the diamond goes on the furthest cell, no longer drawn from the seed first
+//Version 5: the player is a circle that slides along walls (CircleSweep.h)
+//Version 6: a mouse event is the pointer motion gathered over one tick, not the offset from the window centre
+//Version 7: the diamond is reached when the player's circle touches it, not anywhere in its block
+#define REPLAY_VERSION 7
+
+#define REPLAY_FLAG_INFINITE 1 //Chunked unbounded world (--infinite)
+
+enum ReplayEventType {
+	EV_END = 0,
+	EV_KEY_DOWN = 1,
+	EV_KEY_UP = 2,
+	EV_SPECIAL_DOWN = 3,
+	EV_SPECIAL_UP = 4,
+	EV_MOUSE_MOVE = 5
+};
+
+struct ReplayEvent {
+	unsigned int tick;    // simulation tick the event was applied on
+	unsigned int time_ms; // wall clock time since the session started
+	unsigned char type;   // one of ReplayEventType
+	int a, b;             // key code, or mouse motion in x and y
+};
+
+struct Replay {
+	unsigned long long seed;
+	unsigned char flags;
+	std::vector<ReplayEvent> events;
+};
+
+FILE *replay_out = NULL;
+ReplayEvent replay_last = {0, 0, EV_END, 0, 0};
+
+void replay_put_varint(FILE *f, unsigned int v) {
+	while (v >= 0x80) {
+		fputc((v & 0x7f) | 0x80, f);
+		v >>= 7;
+	}
+	fputc(v, f);
+}
+
+bool replay_get_varint(FILE *f, unsigned int *v) {
+	unsigned int result = 0;
+	for (int shift = 0; shift < 35; shift += 7) {
+		int c = fgetc(f);
+		if (c == EOF) return false;
+		result |= (unsigned int)(c & 0x7f) << shift;
+		if (!(c & 0x80)) {
+			*v = result;
+			return true;
+		}
+	}
+	return false;
+}
+
+unsigned int replay_zigzag(int v) { return ((unsigned int)v << 1) ^ (unsigned int)(v >> 31); }
+int replay_unzigzag(unsigned int v) { return (int)(v >> 1) ^ -(int)(v & 1); }
+
+//Start recording into 'path', returns false if the file can't be created
+bool replay_begin_record(const char *path, unsigned long long seed, unsigned char flags) {
+	replay_out = fopen(path, "wb");
+	if (replay_out == NULL) {
+		perror(path);
+		return false;
+	}
+	fwrite("FDRP", 1, 4, replay_out);
+	fputc(REPLAY_VERSION, replay_out);
+	for (int i = 0; i < 8; i++)
+		fputc((int)((seed >> (8 * i)) & 0xff), replay_out);
+	fputc(flags, replay_out);
+	replay_last.tick = 0;
+	replay_last.time_ms = 0;
+	return true;
+}
+
+void replay_record(const ReplayEvent &ev) {
+	if (replay_out == NULL) return;
+	fputc(ev.type, replay_out);
+	replay_put_varint(replay_out, ev.tick - replay_last.tick);
+	replay_put_varint(replay_out, ev.time_ms >= replay_last.time_ms ? ev.time_ms - replay_last.time_ms : 0);
+	switch (ev.type) {
+		case EV_KEY_DOWN:
+		case EV_KEY_UP:
+			fputc(ev.a & 0xff, replay_out);
+			break;
+		case EV_SPECIAL_DOWN:
+		case EV_SPECIAL_UP:
+			replay_put_varint(replay_out, ev.a);
+			break;
+		case EV_MOUSE_MOVE:
+			replay_put_varint(replay_out, replay_zigzag(ev.a));
+			replay_put_varint(replay_out, replay_zigzag(ev.b));
+			break;
+	}
+	replay_last = ev;
+}
+
+//Terminate the stream with an EV_END record stamped with the final tick
+void replay_end_record(unsigned int tick, unsigned int time_ms) {
+	if (replay_out == NULL) return;
+	ReplayEvent end = {tick, time_ms, EV_END, 0, 0};
+	replay_record(end);
+	fclose(replay_out);
+	replay_out = NULL;
+}
+
+//Read a whole recording, the EV_END record is kept as the last event
+bool replay_load(const char *path, Replay *replay) {
+	FILE *in = fopen(path, "rb");
+	if (in == NULL) {
+		perror(path);
+		return false;
+	}
+	char magic[4];
+	if (fread(magic, 1, 4, in) != 4 || memcmp(magic, "FDRP", 4) != 0 || fgetc(in) != REPLAY_VERSION) {
+		fprintf(stderr, "error: %s is not a replay file\n", path);
+		fclose(in);
+		return false;
+	}
+	//8 bytes of seed, then the flags; without them there's nothing to replay
+	unsigned char header[9];
+	if (fread(header, 1, 9, in) != 9) {
+		fprintf(stderr, "error: %s is cut short in its header\n", path);
+		fclose(in);
+		return false;
+	}
+	replay->seed = 0;
+	for (int i = 0; i < 8; i++)
+		replay->seed |= (unsigned long long)header[i] << (8 * i);
+	replay->flags = header[8];
+	replay->events.clear();
+
+	ReplayEvent ev = {0, 0, EV_END, 0, 0};
+	unsigned int dtick, dtime, v1 = 0, v2 = 0;
+	int type;
+	while ((type = fgetc(in)) != EOF) {
+		if (!replay_get_varint(in, &dtick) || !replay_get_varint(in, &dtime)) break;
+		ev.type = type;
+		ev.tick += dtick;
+		ev.time_ms += dtime;
+		ev.a = ev.b = 0;
+		switch (type) {
+			case EV_KEY_DOWN:
+			case EV_KEY_UP: {
+				int c = fgetc(in);
+				if (c == EOF) type = EOF;
+				ev.a = c;
+				break;
+			}
+			case EV_SPECIAL_DOWN:
+			case EV_SPECIAL_UP:
+				if (!replay_get_varint(in, &v1)) type = EOF;
+				ev.a = v1;
+				break;
+			case EV_MOUSE_MOVE:
+				if (!replay_get_varint(in, &v1) || !replay_get_varint(in, &v2)) type = EOF;
+				ev.a = replay_unzigzag(v1);
+				ev.b = replay_unzigzag(v2);
+				break;
+		}
+		if (type == EOF) break;
+		replay->events.push_back(ev);
+		if (type == EV_END) break;
+	}
+	fclose(in);
+
+	if (replay->events.empty() || replay->events.back().type != EV_END) {
+		fprintf(stderr, "warning: %s is truncated, replaying what was read\n", path);
+		ReplayEvent end = {ev.tick, ev.time_ms, EV_END, 0, 0};
+		replay->events.push_back(end);
+	}
+	return true;
+}
+
+#endif
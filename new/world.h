@@ -0,0 +1,294 @@
+#ifndef WORLD_H
+#define WORLD_H
+
+#include <stdlib.h>
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#ifndef GL_GLEXT_PROTOTYPES
+#define GL_GLEXT_PROTOTYPES //glGenBuffers and friends
+#endif
+#include <GL/glut.h>
+
+#include "ChunkMaze.h"
+#include "maze.h"
+#include "collision.h"
+
+//Unbounded maze (--infinite): the world is cut into chunks of CHUNK_CELLS x
+//CHUNK_CELLS maze cells, 2*CHUNK_CELLS blocks a side in the maze[][] block
+//scale. The simulation thread asks for the chunks around the player, worker
+//threads generate and mesh them, and the render thread uploads a few finished
+//meshes to vertex buffers every frame and deletes the buffers of chunks the
+//player has left. Only chunks within CHUNK_KEEP_RADIUS are kept.
+//
+//Collision never waits for the workers: a chunk that is not ready yet is
+//generated on the spot, so the simulation (and a replay) is the same however
+//the workers are scheduled.
+
+#define CHUNK_CELLS 8
+#define CHUNK_BLOCKS (2*CHUNK_CELLS)
+#define CHUNK_LOAD_RADIUS 3 //Chunks requested around the player's chunk
+#define CHUNK_KEEP_RADIUS 4 //Chunks further away are evicted
+#define CHUNK_UPLOADS_PER_FRAME 2 //Vertex buffer uploads allowed per frame
+
+enum ChunkState { CHUNK_QUEUED, CHUNK_WORKING, CHUNK_MESHED, CHUNK_UPLOADED };
+
+struct Chunk {
+	int cx, cz;
+	std::atomic<int> state;
+	bool retired; //Left behind by the player, guarded by worldMutex
+	unsigned char wall[CHUNK_BLOCKS*CHUNK_BLOCKS]; //Written once by a worker, then read only
+	std::vector<float> mesh; //GL_T2F_N3F_V3F quads, walls first, freed after upload
+	int wallVertices, floorVertices;
+	GLuint vbo; //Render thread only
+
+	Chunk(int x, int z) : cx(x), cz(z), state(CHUNK_QUEUED), retired(false),
+		wallVertices(0), floorVertices(0), vbo(0) {}
+};
+
+typedef std::shared_ptr<Chunk> ChunkPtr;
+
+ChunkMaze *worldMaze = NULL;
+bool worldInfinite = false;
+std::mutex worldMutex;
+std::condition_variable worldWork;
+std::unordered_map<unsigned long long, ChunkPtr> worldChunks; //All chunks kept, by world_key
+std::deque<ChunkPtr> worldJobs; //Waiting for a worker, nearest first
+std::vector<ChunkPtr> worldUploads; //Meshed, waiting for the render thread
+std::vector<ChunkPtr> worldRetired; //Evicted, vertex buffers still to delete
+std::vector<std::thread> worldWorkers;
+bool worldStopping = false;
+int worldCenterX = 0x7fffffff, worldCenterZ = 0x7fffffff;
+
+//Simulation thread only: the last chunk generated for a collision query
+int collisionCx = 0x7fffffff, collisionCz = 0x7fffffff;
+unsigned char collisionWall[CHUNK_BLOCKS*CHUNK_BLOCKS];
+
+unsigned long long world_key(int cx, int cz) {
+	return (unsigned long long)(unsigned int)cx << 32 | (unsigned int)cz;
+}
+
+//Floor division, chunk coordinate of a block
+int world_chunk(int b) {
+	return b >= 0 ? b / CHUNK_BLOCKS : -((-b + CHUNK_BLOCKS - 1) / CHUNK_BLOCKS);
+}
+
+//Collision lookup for collision.h, block (bx, bz) is world position (2*bx, 2*bz)
+bool world_is_wall(int bx, int bz) {
+	int cx = world_chunk(bx), cz = world_chunk(bz);
+	int lx = bx - cx * CHUNK_BLOCKS, lz = bz - cz * CHUNK_BLOCKS;
+	{
+		std::lock_guard<std::mutex> lock(worldMutex);
+		std::unordered_map<unsigned long long, ChunkPtr>::iterator it = worldChunks.find(world_key(cx, cz));
+		if (it != worldChunks.end() && it->second->state.load(std::memory_order_acquire) >= CHUNK_MESHED)
+			return it->second->wall[lz * CHUNK_BLOCKS + lx];
+	}
+	if (cx != collisionCx || cz != collisionCz) {
+		worldMaze->blocks(cx, cz, collisionWall);
+		collisionCx = cx;
+		collisionCz = cz;
+	}
+	return collisionWall[lz * CHUNK_BLOCKS + lx];
+}
+
+void world_quad(std::vector<float> &m, const float v[4][3], float nx, float ny, float nz) {
+	static const float t[4][2] = {{0,0}, {1,0}, {1,1}, {0,1}};
+	for (int i = 0; i < 4; i++) {
+		float vertex[8] = {t[i][0], t[i][1], nx, ny, nz, v[i][0], v[i][1], v[i][2]};
+		m.insert(m.end(), vertex, vertex + 8);
+	}
+}
+
+//Build the vertex data of a generated chunk: a cube per wall block without
+//the faces shared with another wall block of the chunk, a quad per floor block
+void world_mesh(Chunk &c) {
+	std::vector<float> &m = c.mesh;
+	m.clear();
+	for (int pass = 0; pass < 2; pass++) {
+		for (int bz = 0; bz < CHUNK_BLOCKS; bz++) {
+			for (int bx = 0; bx < CHUNK_BLOCKS; bx++) {
+				bool wall = c.wall[bz * CHUNK_BLOCKS + bx];
+				float X = 2 * bx, Z = 2 * bz;
+				if (pass == 1) {
+					if (wall) continue;
+					const float f[4][3] = {{X-1,-1,Z+1}, {X+1,-1,Z+1}, {X+1,-1,Z-1}, {X-1,-1,Z-1}};
+					world_quad(m, f, 0, 1, 0);
+					continue;
+				}
+				if (!wall) continue;
+				#define WALL_AT(x, z) ((x) >= 0 && (z) >= 0 && (x) < CHUNK_BLOCKS && (z) < CHUNK_BLOCKS && c.wall[(z) * CHUNK_BLOCKS + (x)])
+				const float top[4][3] = {{X-1,1,Z+1}, {X+1,1,Z+1}, {X+1,1,Z-1}, {X-1,1,Z-1}};
+				world_quad(m, top, 0, 1, 0);
+				if (!WALL_AT(bx, bz + 1)) {
+					const float s[4][3] = {{X-1,-1,Z+1}, {X+1,-1,Z+1}, {X+1,1,Z+1}, {X-1,1,Z+1}};
+					world_quad(m, s, 0, 0, 1);
+				}
+				if (!WALL_AT(bx, bz - 1)) {
+					const float s[4][3] = {{X+1,-1,Z-1}, {X-1,-1,Z-1}, {X-1,1,Z-1}, {X+1,1,Z-1}};
+					world_quad(m, s, 0, 0, -1);
+				}
+				if (!WALL_AT(bx + 1, bz)) {
+					const float s[4][3] = {{X+1,-1,Z+1}, {X+1,-1,Z-1}, {X+1,1,Z-1}, {X+1,1,Z+1}};
+					world_quad(m, s, 1, 0, 0);
+				}
+				if (!WALL_AT(bx - 1, bz)) {
+					const float s[4][3] = {{X-1,-1,Z-1}, {X-1,-1,Z+1}, {X-1,1,Z+1}, {X-1,1,Z-1}};
+					world_quad(m, s, -1, 0, 0);
+				}
+				#undef WALL_AT
+			}
+		}
+		if (pass == 0) c.wallVertices = m.size() / 8;
+	}
+	c.floorVertices = m.size() / 8 - c.wallVertices;
+}
+
+void world_worker() {
+	for (;;) {
+		ChunkPtr c;
+		{
+			std::unique_lock<std::mutex> lock(worldMutex);
+			worldWork.wait(lock, [] { return worldStopping || !worldJobs.empty(); });
+			if (worldStopping) return;
+			c = worldJobs.front();
+			worldJobs.pop_front();
+			if (c->retired) continue;
+			c->state.store(CHUNK_WORKING, std::memory_order_relaxed);
+		}
+		worldMaze->blocks(c->cx, c->cz, c->wall);
+		world_mesh(*c);
+		c->state.store(CHUNK_MESHED, std::memory_order_release);
+		std::lock_guard<std::mutex> lock(worldMutex);
+		if (!c->retired) worldUploads.push_back(c);
+	}
+}
+
+//Simulation thread: request the chunks around the player and evict the far ones
+void world_update(float px, float pz) {
+	if (worldWorkers.empty()) return; //Headless, collision generates what it needs
+	int cx = world_chunk((int)round(px / 2)), cz = world_chunk((int)round(pz / 2));
+	if (cx == worldCenterX && cz == worldCenterZ) return;
+	worldCenterX = cx;
+	worldCenterZ = cz;
+
+	std::lock_guard<std::mutex> lock(worldMutex);
+	for (std::unordered_map<unsigned long long, ChunkPtr>::iterator it = worldChunks.begin(); it != worldChunks.end(); ) {
+		Chunk &c = *it->second;
+		if (abs(c.cx - cx) > CHUNK_KEEP_RADIUS || abs(c.cz - cz) > CHUNK_KEEP_RADIUS) {
+			c.retired = true;
+			worldRetired.push_back(it->second);
+			it = worldChunks.erase(it);
+		} else ++it;
+	}
+	//Requests go out in rings around the player, the nearest chunks first
+	worldJobs.clear();
+	for (int r = 0; r <= CHUNK_LOAD_RADIUS; r++) {
+		for (int dz = -r; dz <= r; dz++) {
+			for (int dx = -r; dx <= r; dx++) {
+				if (std::max(abs(dx), abs(dz)) != r) continue;
+				ChunkPtr &c = worldChunks[world_key(cx + dx, cz + dz)];
+				if (!c) c = std::make_shared<Chunk>(cx + dx, cz + dz);
+				if (c->state.load(std::memory_order_acquire) == CHUNK_QUEUED) worldJobs.push_back(c);
+			}
+		}
+	}
+	worldWork.notify_all();
+}
+
+//Render thread: delete the buffers of evicted chunks and upload at most
+//'budget' finished meshes, so a burst of new chunks is spread over frames
+void world_upload(int budget) {
+	std::vector<ChunkPtr> retired, ready;
+	{
+		std::lock_guard<std::mutex> lock(worldMutex);
+		retired.swap(worldRetired);
+		int n = std::min((int)worldUploads.size(), budget);
+		ready.assign(worldUploads.begin(), worldUploads.begin() + n);
+		worldUploads.erase(worldUploads.begin(), worldUploads.begin() + n);
+	}
+	for (size_t i = 0; i < retired.size(); i++)
+		if (retired[i]->vbo) {
+			glDeleteBuffers(1, &retired[i]->vbo);
+			retired[i]->vbo = 0;
+		}
+	for (size_t i = 0; i < ready.size(); i++) {
+		Chunk &c = *ready[i];
+		glGenBuffers(1, &c.vbo);
+		glBindBuffer(GL_ARRAY_BUFFER, c.vbo);
+		glBufferData(GL_ARRAY_BUFFER, c.mesh.size() * sizeof(float), c.mesh.data(), GL_STATIC_DRAW);
+		std::vector<float>().swap(c.mesh);
+		c.state.store(CHUNK_UPLOADED, std::memory_order_release);
+	}
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+	//A chunk evicted while it was being uploaded is released next frame
+	std::lock_guard<std::mutex> lock(worldMutex);
+	for (size_t i = 0; i < ready.size(); i++)
+		if (ready[i]->retired) worldRetired.push_back(ready[i]);
+}
+
+//Render thread: draw every uploaded chunk
+void world_draw(unsigned int wallTexture, unsigned int floorTexture) {
+	std::vector<ChunkPtr> visible;
+	{
+		std::lock_guard<std::mutex> lock(worldMutex);
+		for (std::unordered_map<unsigned long long, ChunkPtr>::iterator it = worldChunks.begin(); it != worldChunks.end(); ++it)
+			if (it->second->state.load(std::memory_order_acquire) == CHUNK_UPLOADED) visible.push_back(it->second);
+	}
+	glEnable(GL_TEXTURE_2D);
+	for (size_t i = 0; i < visible.size(); i++) {
+		Chunk &c = *visible[i];
+		glPushMatrix();
+			glTranslatef(2 * c.cx * CHUNK_BLOCKS, 0, 2 * c.cz * CHUNK_BLOCKS);
+			glBindBuffer(GL_ARRAY_BUFFER, c.vbo);
+			glInterleavedArrays(GL_T2F_N3F_V3F, 0, NULL);
+			glBindTexture(GL_TEXTURE_2D, wallTexture);
+			glColor4f(1, 1, 1, 1);
+			glDrawArrays(GL_QUADS, 0, c.wallVertices);
+			glBindTexture(GL_TEXTURE_2D, floorTexture);
+			glColor3f(0.9f, 0.9f, 0.9f);
+			glDrawArrays(GL_QUADS, c.wallVertices, c.floorVertices);
+		glPopMatrix();
+	}
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+	glDisableClientState(GL_TEXTURE_COORD_ARRAY);
+	glDisableClientState(GL_NORMAL_ARRAY);
+	glDisableClientState(GL_VERTEX_ARRAY);
+	glDisable(GL_TEXTURE_2D);
+}
+
+//Switch collision to the chunked world and put the diamond a few chunks away
+void world_init(unsigned long long seed) {
+	worldMaze = new ChunkMaze(seed, CHUNK_CELLS);
+	worldInfinite = true;
+	wallLookup = world_is_wall;
+	diamondx = 2 * (3 * CHUNK_BLOCKS + CHUNK_CELLS + 1);
+	diamondz = 2 * (3 * CHUNK_BLOCKS + CHUNK_CELLS + 1);
+}
+
+void world_stop() {
+	{
+		std::lock_guard<std::mutex> lock(worldMutex);
+		worldStopping = true;
+	}
+	worldWork.notify_all();
+	for (size_t i = 0; i < worldWorkers.size(); i++)
+		if (worldWorkers[i].joinable()) worldWorkers[i].join();
+}
+
+//Start the chunk workers, leaving a core for the simulation and one for rendering
+void world_start_workers() {
+	int n = (int)std::thread::hardware_concurrency() - 2;
+	n = std::max(1, std::min(n, 4));
+	for (int i = 0; i < n; i++)
+		worldWorkers.push_back(std::thread(world_worker));
+	atexit(world_stop);
+}
+
+#endif
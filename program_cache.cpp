@@ -0,0 +1,91 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <GL/glew.h>
+#include <learnopengl/program_cache_format.h>
+#include "program_cache.h"
+
+static int binary_supported() {
+  return GLEW_VERSION_4_1 || GLEW_ARB_get_program_binary;
+}
+
+unsigned long long program_cache_key(int count, const GLenum* types, const char* const* sources, const GLint* geometry) {
+  unsigned long long hash = program_cache_key_begin((const char*)glGetString(GL_VENDOR),
+                                                    (const char*)glGetString(GL_RENDERER),
+                                                    (const char*)glGetString(GL_VERSION));
+  for (int i = 0; i < count; i++) {
+    hash = program_cache_hash(hash, &types[i], sizeof(types[i]));
+    hash = program_cache_hash_str(hash, sources[i]);
+  }
+  /* input type, output type and vertex count are set at link time, not in the source */
+  if (geometry != NULL)
+    hash = program_cache_hash(hash, geometry, 3 * sizeof(GLint));
+  return hash;
+}
+
+/* Ask the driver to keep the binary around, call before glLinkProgram */
+void program_cache_prepare(GLuint program) {
+  if (binary_supported())
+    glProgramParameteri(program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+}
+
+/* Returns 1 if 'program' was linked from the cache */
+int program_cache_load(GLuint program, unsigned long long key) {
+  if (!binary_supported()) return 0;
+  char path[512];
+  program_cache_path(key, path, sizeof(path));
+  FILE* in = fopen(path, "rb");
+  if (in == NULL) return 0;
+
+  struct program_cache_header header;
+  void* binary = NULL;
+  int ok = fread(&header, sizeof(header), 1, in) == 1
+        && program_cache_header_valid(&header, key)
+        && (binary = malloc(header.length)) != NULL
+        && fread(binary, 1, header.length, in) == (size_t)header.length;
+  fclose(in);
+
+  GLint link_ok = GL_FALSE;
+  if (ok) {
+    glProgramBinary(program, header.format, binary, header.length);
+    glGetProgramiv(program, GL_LINK_STATUS, &link_ok);
+  }
+  free(binary);
+  if (!link_ok) {
+    /* stale or rejected by the driver, it gets rebuilt from source */
+    remove(path);
+    return 0;
+  }
+  return 1;
+}
+
+void program_cache_store(GLuint program, unsigned long long key) {
+  if (!binary_supported()) return;
+  struct program_cache_header header;
+  program_cache_header_init(&header, key);
+  GLint length = 0;
+  glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+  if (length <= 0) return;
+  header.length = length;
+
+  void* binary = malloc(length);
+  GLenum format = 0;
+  glGetProgramBinary(program, length, NULL, &format, binary);
+  header.format = format;
+
+  char path[512], tmp[520];
+  mkdir(program_cache_dir(), 0755);
+  program_cache_path(key, path, sizeof(path));
+  snprintf(tmp, sizeof(tmp), "%s.tmp", path);
+
+  /* write to a temporary name first so a crash never leaves a torn entry */
+  FILE* out = fopen(tmp, "wb");
+  if (out != NULL) {
+    int ok = fwrite(&header, sizeof(header), 1, out) == 1
+          && fwrite(binary, 1, header.length, out) == (size_t)header.length;
+    if (fclose(out) == 0 && ok) rename(tmp, path);
+    else remove(tmp);
+  }
+  free(binary);
+}
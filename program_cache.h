@@ -0,0 +1,17 @@
+#ifndef _PROGRAM_CACHE_H
+#define _PROGRAM_CACHE_H
+#include <GL/glew.h>
+/*
+ * On-disk cache of linked program binaries (GL 4.1 / ARB_get_program_binary).
+ * Entries are keyed on the shader sources plus the GL vendor, renderer and
+ * version strings, so a driver update or a shader edit misses the cache.
+ * 'geometry' is the geometry shader's input type, output type and vertex
+ * count, or NULL without one. The file format is shared with learnopengl's
+ * ProgramCache (learnopengl/program_cache_format.h).
+ * The directory is $SHADER_CACHE_DIR, or ./.shader_cache by default.
+ */
+unsigned long long program_cache_key(int count, const GLenum* types, const char* const* sources, const GLint* geometry);
+void program_cache_prepare(GLuint program);
+int program_cache_load(GLuint program, unsigned long long key);
+void program_cache_store(GLuint program, unsigned long long key);
+#endif
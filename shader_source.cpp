@@ -0,0 +1,182 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "file_utils.h"
+#include "shader_source.h"
+
+struct expanded_source {
+  std::string filename, defines, text;
+};
+
+static std::unordered_map<std::string, std::string> file_cache;  /* path -> contents */
+static std::unordered_map<unsigned long long, expanded_source> source_cache;
+
+static unsigned long long fnv1a(unsigned long long hash, const char* s) {
+  for (const char* p = s ? s : ""; ; p++) {
+    hash ^= (unsigned char)*p;
+    hash *= 1099511628211ULL;
+    if (*p == '\0') return hash;
+  }
+}
+
+static const std::string* cached_file(const std::string& path) {
+  std::unordered_map<std::string, std::string>::iterator it = file_cache.find(path);
+  if (it != file_cache.end()) return &it->second;
+  size_t size;
+  char* data = file_read_size(path.c_str(), &size);
+  if (data == NULL) return NULL;
+  const std::string* res = &file_cache.insert(std::make_pair(path, std::string(data, size))).first->second;
+  free(data);
+  return res;
+}
+
+static const char* skip_blanks(const char* p, const char* end) {
+  while (p < end && (*p == ' ' || *p == '\t')) p++;
+  return p;
+}
+
+/* If [p, end) is a '#<directive>' line return the text after the directive */
+static const char* directive(const char* p, const char* end, const char* name) {
+  p = skip_blanks(p, end);
+  if (p == end || *p != '#') return NULL;
+  p = skip_blanks(p + 1, end);
+  size_t len = strlen(name);
+  if ((size_t)(end - p) < len || strncmp(p, name, len) != 0) return NULL;
+  return p + len;
+}
+
+static bool parse_include(const char* line, const char* end, std::string* name) {
+  const char* p = directive(line, end, "include");
+  if (p == NULL) return false;
+  p = skip_blanks(p, end);
+  char close = (p < end && *p == '"') ? '"' : (p < end && *p == '<') ? '>' : 0;
+  if (!close) return false;
+  const char* q = (const char*)memchr(p + 1, close, end - p - 1);
+  if (q == NULL) return false;
+  name->assign(p + 1, q);
+  return true;
+}
+
+static void append_line_directive(std::string& out, int line) {
+  char buf[32];
+  snprintf(buf, sizeof(buf), "#line %d\n", line);
+  out += buf;
+}
+
+/* Append 'path' to 'out' with its #include lines replaced, recursively */
+static bool expand(const std::string& path, std::string& out, std::vector<std::string>& stack) {
+  const std::string* src = cached_file(path);
+  if (src == NULL) {
+    fprintf(stderr, "Error opening %s: ", path.c_str()); perror("");
+    return false;
+  }
+  std::string dir;
+  size_t slash = path.find_last_of('/');
+  if (slash != std::string::npos) dir = path.substr(0, slash + 1);
+
+  stack.push_back(path);
+  const char* p = src->data();
+  const char* end = p + src->size();
+  bool ok = true;
+  for (int line = 1; p < end && ok; line++) {
+    const char* eol = (const char*)memchr(p, '\n', end - p);
+    const char* next = eol ? eol + 1 : end;
+    std::string name;
+    if (parse_include(p, next, &name)) {
+      std::string inc = name[0] == '/' ? name : dir + name;
+      if (std::find(stack.begin(), stack.end(), inc) != stack.end()) {
+        fprintf(stderr, "%s:%d: recursive #include of %s\n", path.c_str(), line, inc.c_str());
+        ok = false;
+      } else {
+        append_line_directive(out, 1);
+        if (!expand(inc, out, stack)) {
+          fprintf(stderr, "  included from %s:%d\n", path.c_str(), line);
+          ok = false;
+        }
+        append_line_directive(out, line + 1);
+      }
+    } else {
+      out.append(p, next);
+    }
+    p = next;
+  }
+  if (!out.empty() && out[out.size() - 1] != '\n') out += '\n';
+  stack.pop_back();
+  return ok;
+}
+
+static void append_defines(std::string& out, const char* defines) {
+  for (const char* p = defines; p && *p; ) {
+    const char* end = strchr(p, ';');
+    if (end == NULL) end = p + strlen(p);
+    const char* name = skip_blanks(p, end);
+    const char* last = end;
+    while (last > name && (last[-1] == ' ' || last[-1] == '\t')) last--;
+    if (name < last) {
+      const char* eq = (const char*)memchr(name, '=', last - name);
+      out += "#define ";
+      if (eq) {
+        out.append(name, eq);
+        out += ' ';
+        out.append(eq + 1, last);
+      } else {
+        out.append(name, last);
+      }
+      out += '\n';
+    }
+    p = *end ? end + 1 : end;
+  }
+}
+
+/* Offset just past the #version line of 'text', 0 if it has none */
+size_t shader_source_version_end(const char* text) {
+  const char* end = text + strlen(text);
+  for (const char* p = text; p < end; ) {
+    const char* eol = (const char*)memchr(p, '\n', end - p);
+    const char* next = eol ? eol + 1 : end;
+    if (directive(p, next, "version")) return next - text;
+    p = next;
+  }
+  return 0;
+}
+
+const char* shader_source(const char* filename, const char* defines) {
+  unsigned long long key = fnv1a(fnv1a(14695981039346656037ULL, filename), defines);
+  std::unordered_map<unsigned long long, expanded_source>::iterator it = source_cache.find(key);
+  if (it != source_cache.end()) {
+    const expanded_source& e = it->second;
+    if (e.filename == filename && e.defines == (defines ? defines : ""))
+      return e.text.c_str();
+    source_cache.erase(it);  /* hash collision, the newer variant wins */
+  }
+
+  std::string body;
+  std::vector<std::string> stack;
+  if (!expand(filename, body, stack)) return NULL;
+
+  /* #version has to stay first, the defines go right after it */
+  size_t version_end = shader_source_version_end(body.c_str());
+  int body_line = 1;
+  for (size_t i = 0; i < version_end; i++)
+    if (body[i] == '\n') body_line++;
+
+  expanded_source e;
+  e.filename = filename;
+  e.defines = defines ? defines : "";
+  e.text.reserve(body.size() + e.defines.size() + 64);
+  e.text.append(body, 0, version_end);
+  append_defines(e.text, defines);
+  append_line_directive(e.text, body_line);
+  e.text.append(body, version_end, std::string::npos);
+  return source_cache.insert(std::make_pair(key, e)).first->second.text.c_str();
+}
+
+/* Forget every file and expansion, e.g. after shaders were edited on disk */
+void shader_source_flush() {
+  source_cache.clear();
+  file_cache.clear();
+}
@@ -0,0 +1,19 @@
+#ifndef _SHADER_SOURCE_H
+#define _SHADER_SOURCE_H
+#include <stddef.h>
+/*
+ * GLSL preprocessing done before a shader reaches the driver:
+ *  - #include "file" lines are replaced by the file, resolved relative to the
+ *    including file, with #line directives so compiler messages keep the
+ *    line numbers of the file they refer to
+ *  - 'defines', a ';' separated list of NAME or NAME=VALUE (may be NULL), is
+ *    injected as #define lines right after the #version line, or at the top
+ * Files are read once and expanded sources are cached on a hash of the file
+ * name and the defines, so shader variants are assembled without touching
+ * the disk again. Returned strings belong to the cache and stay valid until
+ * shader_source_flush(). Not thread safe, call from the GL thread.
+ */
+const char* shader_source(const char* filename, const char* defines);
+size_t shader_source_version_end(const char* text);
+void shader_source_flush();
+#endif
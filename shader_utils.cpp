@@ -6,32 +6,18 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <GL/glew.h>
-
-/* Store all the file's contents in memory, useful to pass shaders source code to OpenGL */
-char* file_read(const char* filename) {
-  FILE* in = fopen(filename, "rb");
-  if (in == NULL) return NULL;
-
-  int res_size = BUFSIZ;
-  char* res = (char*)malloc(res_size);
-  int nb_read_total = 0;
-
-  while (!feof(in) && !ferror(in)) {
-    if (nb_read_total + BUFSIZ > res_size) {
-      if (res_size > 10*1024*1024) break;
-      res_size = res_size * 2;
-      res = (char*)realloc(res, res_size);
-    }
-    char* p_res = res + nb_read_total;
-    nb_read_total += fread(p_res, 1, BUFSIZ, in);
-  }
-
-  fclose(in);
-  res = (char*)realloc(res, nb_read_total + 1);
-  res[nb_read_total] = '\0';
-  return res;
-}
+#ifdef _WIN32
+#define GET_PROC_ADDRESS(name) wglGetProcAddress(name)
+#else
+#include <GL/glx.h>
+#define GET_PROC_ADDRESS(name) glXGetProcAddressARB((const GLubyte*)(name))
+#endif
+#include "file_utils.h"
+#include "program_cache.h"
+#include "shader_source.h"
+#include "shader_utils.h"
 
 /* Display compilation errors from the OpenGL shader compiler */
 void print_log(GLuint object) {
@@ -56,46 +42,56 @@ void print_log(GLuint object) {
   free(log);
 }
 
-/* Compile the shader from file 'filename', with error handling */
-GLuint create_shader(const char* filename, GLenum type) {
-  const GLchar* source = file_read(filename);
-  if (source == NULL) {
-    fprintf(stderr, "Error opening %s: ", filename); perror("");
-    return 0;
-  }
-  GLuint res = glCreateShader(type);
-  const GLchar* sources[] = {
-    // Define GLSL version
+/* Version and precision lines put in front of every shader source */
+static void shader_prefix(GLenum type, const GLchar* prefix[2]) {
+  // Define GLSL version
 #ifdef GL_ES_VERSION_2_0
-    "#version 100\n"  // OpenGL ES 2.0
+  prefix[0] = "#version 100\n";  // OpenGL ES 2.0
 #else
-    "#version 120\n"  // OpenGL 2.1
+  prefix[0] = "#version 120\n";  // OpenGL 2.1
 #endif
-    ,
-    // GLES2 precision specifiers
+  // GLES2 precision specifiers
 #ifdef GL_ES_VERSION_2_0
-    // Define default float precision for fragment shaders:
-    (type == GL_FRAGMENT_SHADER) ?
+  // Define default float precision for fragment shaders:
+  prefix[1] = (type == GL_FRAGMENT_SHADER) ?
     "#ifdef GL_FRAGMENT_PRECISION_HIGH\n"
     "precision highp float;           \n"
     "#else                            \n"
     "precision mediump float;         \n"
     "#endif                           \n"
-    : ""
-    // Note: OpenGL ES automatically defines this:
-    // #define GL_ES
+    : "";
+  // Note: OpenGL ES automatically defines this:
+  // #define GL_ES
 #else
-    // Ignore GLES 2 precision specifiers:
+  // Ignore GLES 2 precision specifiers:
+  prefix[1] =
     "#define lowp   \n"
     "#define mediump\n"
-    "#define highp  \n"
+    "#define highp  \n";
 #endif
-    ,
-    source };
-  glShaderSource(res, 3, sources, NULL);
-  free((void*)source);
+}
 
+/* Start compiling 'source', the driver may finish it in the background */
+static GLuint submit_shader(const GLchar* source, GLenum type) {
+  GLuint res = glCreateShader(type);
+  const GLchar* sources[3];
+  GLint lengths[3] = { -1, -1, -1 };
+  shader_prefix(type, sources);
+  sources[2] = source;
+  /* a shader with its own #version keeps it, the precision lines go after it */
+  size_t version_end = shader_source_version_end(source);
+  if (version_end > 0) {
+    sources[0] = source;
+    lengths[0] = (GLint)version_end;
+    sources[2] = source + version_end;
+  }
+  glShaderSource(res, 3, sources, lengths);
   glCompileShader(res);
+  return res;
+}
+
+/* Wait for a submitted shader and report errors, returns 0 if it failed */
+static GLuint finish_shader(GLuint res, const char* filename) {
   GLint compile_ok = GL_FALSE;
   glGetShaderiv(res, GL_COMPILE_STATUS, &compile_ok);
   if (compile_ok == GL_FALSE) {
@@ -104,82 +100,172 @@ GLuint create_shader(const char* filename, GLenum type) {
     glDeleteShader(res);
     return 0;
   }
-
   return res;
 }
 
+/* Compile the shader from file 'filename', with error handling */
+GLuint create_shader(const char* filename, GLenum type) {
+  return create_shader_variant(filename, type, NULL);
+}
+
+/* Same as create_shader, with 'defines' (see shader_source.h) injected */
+GLuint create_shader_variant(const char* filename, GLenum type, const char* defines) {
+  const GLchar* source = shader_source(filename, defines);
+  if (source == NULL)
+    return 0;
+  return finish_shader(submit_shader(source, type), filename);
+}
+
+typedef void (GLAPIENTRY *PFN_MAX_SHADER_COMPILER_THREADS)(GLuint count);
+
+static int has_extension(const char* name) {
+  const char* list = (const char*)glGetString(GL_EXTENSIONS);
+  size_t len = strlen(name);
+  for (const char* p = list; p && (p = strstr(p, name)) != NULL; p += len)
+    if ((p == list || p[-1] == ' ') && (p[len] == ' ' || p[len] == '\0'))
+      return 1;
+  return 0;
+}
+
+/* Let the driver compile on as many threads as it likes (KHR/ARB_parallel_shader_compile) */
+static void enable_parallel_compile() {
+  static int done = 0;
+  if (done) return;
+  done = 1;
+  PFN_MAX_SHADER_COMPILER_THREADS max_threads = NULL;
+  if (has_extension("GL_KHR_parallel_shader_compile"))
+    max_threads = (PFN_MAX_SHADER_COMPILER_THREADS)GET_PROC_ADDRESS("glMaxShaderCompilerThreadsKHR");
+  else if (has_extension("GL_ARB_parallel_shader_compile"))
+    max_threads = (PFN_MAX_SHADER_COMPILER_THREADS)GET_PROC_ADDRESS("glMaxShaderCompilerThreadsARB");
+  if (max_threads)
+    max_threads(0xFFFFFFFF);
+}
+
+struct pending_program {
+  GLuint shaders[3];
+  const char* files[3];
+  int count;
+  int cached;
+  unsigned long long key;
+};
+
+/*
+ * Build every program in 'programs'. Programs whose binary is in the cache
+ * are loaded directly. The rest are compiled together: all shaders are
+ * submitted, then all programs are linked, and only then is any status
+ * queried, so a driver with parallel compilation works on all of them at
+ * once. Returns 1 if every program was built.
+ */
+int create_programs(struct program_desc* programs, int count) {
+  int all_ok = 1;
+  struct pending_program* pending = (struct pending_program*)calloc(count, sizeof(struct pending_program));
+  enable_parallel_compile();
+
+  for (int i = 0; i < count; i++) {
+    struct program_desc* desc = &programs[i];
+    struct pending_program* p = &pending[i];
+    const char* files[3] = { desc->vertexfile, desc->geometryfile, desc->fragmentfile };
+    const GLenum all_types[3] = { GL_VERTEX_SHADER, GL_GEOMETRY_SHADER, GL_FRAGMENT_SHADER };
+    GLenum types[3];
+    const char* sources[3];
+    int ok = 1;
+    desc->program = 0;
+
+    for (int s = 0; s < 3; s++) {
+      if (files[s] == NULL) continue;
+#ifndef GL_GEOMETRY_SHADER
+      if (s == 1) {
+        fprintf(stderr, "Missing support for geometry shaders.\n");
+        ok = 0;
+        break;
+      }
+#endif
+      const char* source = shader_source(files[s], desc->defines);
+      if (source == NULL) {
+        ok = 0;
+        break;
+      }
+      p->files[p->count] = files[s];
+      types[p->count] = all_types[s];
+      sources[p->count++] = source;
+    }
+
+    if (ok) {
+      desc->program = glCreateProgram();
+      const GLint geometry[3] = { desc->input, desc->output, desc->vertices };
+      unsigned long long key = program_cache_key(p->count, types, sources, desc->geometryfile ? geometry : NULL);
+      p->cached = program_cache_load(desc->program, key);
+      if (!p->cached)
+        for (int s = 0; s < p->count; s++)
+          p->shaders[s] = submit_shader(sources[s], types[s]);
+      p->key = key;
+    }
+    if (!ok) {
+      p->count = 0;
+      all_ok = 0;
+    }
+  }
+
+  for (int i = 0; i < count; i++) {
+    struct program_desc* desc = &programs[i];
+    struct pending_program* p = &pending[i];
+    if (desc->program == 0 || p->cached) continue;
+    for (int s = 0; s < p->count; s++)
+      glAttachShader(desc->program, p->shaders[s]);
+#ifdef GL_GEOMETRY_SHADER
+    if (desc->geometryfile) {
+      glProgramParameteriEXT(desc->program, GL_GEOMETRY_INPUT_TYPE_EXT, desc->input);
+      glProgramParameteriEXT(desc->program, GL_GEOMETRY_OUTPUT_TYPE_EXT, desc->output);
+      glProgramParameteriEXT(desc->program, GL_GEOMETRY_VERTICES_OUT_EXT, desc->vertices);
+    }
+#endif
+    program_cache_prepare(desc->program);
+    glLinkProgram(desc->program);
+  }
+
+  for (int i = 0; i < count; i++) {
+    struct program_desc* desc = &programs[i];
+    struct pending_program* p = &pending[i];
+    if (desc->program == 0 || p->cached) continue;
+    int ok = 1;
+    for (int s = 0; s < p->count; s++) {
+      if (!finish_shader(p->shaders[s], p->files[s]))
+        ok = 0;
+      else
+        glDeleteShader(p->shaders[s]);  // freed once the program goes away
+    }
+    GLint link_ok = GL_FALSE;
+    if (ok) {
+      glGetProgramiv(desc->program, GL_LINK_STATUS, &link_ok);
+      if (!link_ok) {
+        fprintf(stderr, "glLinkProgram:");
+        print_log(desc->program);
+      }
+    }
+    if (!link_ok) {
+      glDeleteProgram(desc->program);
+      desc->program = 0;
+      all_ok = 0;
+      continue;
+    }
+    program_cache_store(desc->program, p->key);
+  }
+
+  free(pending);
+  return all_ok;
+}
+
 GLuint create_program(const char *vertexfile, const char *fragmentfile) {
-	GLuint program = glCreateProgram();
-	GLuint shader;
-
-	if(vertexfile) {
-		shader = create_shader(vertexfile, GL_VERTEX_SHADER);
-		if(!shader)
-			return 0;
-		glAttachShader(program, shader);
-	}
-
-	if(fragmentfile) {
-		shader = create_shader(fragmentfile, GL_FRAGMENT_SHADER);
-		if(!shader)
-			return 0;
-		glAttachShader(program, shader);
-	}
-
-	glLinkProgram(program);
-	GLint link_ok = GL_FALSE;
-	glGetProgramiv(program, GL_LINK_STATUS, &link_ok);
-	if (!link_ok) {
-		fprintf(stderr, "glLinkProgram:");
-		print_log(program);
-		glDeleteProgram(program);
-		return 0;
-	}
-
-	return program;
+	struct program_desc desc = { vertexfile, NULL, fragmentfile };
+	create_programs(&desc, 1);
+	return desc.program;
 }
 
 #ifdef GL_GEOMETRY_SHADER
 GLuint create_gs_program(const char *vertexfile, const char *geometryfile, const char *fragmentfile, GLint input, GLint output, GLint vertices) {
-	GLuint program = glCreateProgram();
-	GLuint shader;
-
-	if(vertexfile) {
-		shader = create_shader(vertexfile, GL_VERTEX_SHADER);
-		if(!shader)
-			return 0;
-		glAttachShader(program, shader);
-	}
-
-	if(geometryfile) {
-		shader = create_shader(geometryfile, GL_GEOMETRY_SHADER);
-		if(!shader)
-			return 0;
-		glAttachShader(program, shader);
-
-		glProgramParameteriEXT(program, GL_GEOMETRY_INPUT_TYPE_EXT, input);
-		glProgramParameteriEXT(program, GL_GEOMETRY_OUTPUT_TYPE_EXT, output);
-		glProgramParameteriEXT(program, GL_GEOMETRY_VERTICES_OUT_EXT, vertices);
-	}
-
-	if(fragmentfile) {
-		shader = create_shader(fragmentfile, GL_FRAGMENT_SHADER);
-		if(!shader)
-			return 0;
-		glAttachShader(program, shader);
-	}
-
-	glLinkProgram(program);
-	GLint link_ok = GL_FALSE;
-	glGetProgramiv(program, GL_LINK_STATUS, &link_ok);
-	if (!link_ok) {
-		fprintf(stderr, "glLinkProgram:");
-		print_log(program);
-		glDeleteProgram(program);
-		return 0;
-	}
-
-	return program;
+	struct program_desc desc = { vertexfile, geometryfile, fragmentfile, input, output, vertices };
+	create_programs(&desc, 1);
+	return desc.program;
 }
 #else
 GLuint create_gs_program(const char *vertexfile, const char *geometryfile, const char *fragmentfile, GLint input, GLint output, GLint vertices) {
@@ -6,11 +6,24 @@
 #ifndef _CREATE_SHADER_H
 #define _CREATE_SHADER_H
 #include <GL/glew.h>
-char* file_read(const char* filename);
+#include "file_utils.h"
+
+/* One program for create_programs, 'program' is filled in (0 on failure) */
+struct program_desc {
+  const char* vertexfile;
+  const char* geometryfile;  /* may be NULL, as may vertexfile */
+  const char* fragmentfile;
+  GLint input, output, vertices;  /* geometry shader parameters */
+  GLuint program;
+  const char* defines;  /* injected into every stage, see shader_source.h */
+};
+
 void print_log(GLuint object);
 GLuint create_shader(const char* filename, GLenum type);
+GLuint create_shader_variant(const char* filename, GLenum type, const char* defines);
 GLuint create_program(const char* vertexfile, const char *fragmentfile);
 GLuint create_gs_program(const char* vertexfile, const char *geometryfile, const char *fragmentfile, GLint input, GLint output, GLint vertices);
+int create_programs(struct program_desc* programs, int count);
 GLint get_attrib(GLuint program, const char *name);
 GLint get_uniform(GLuint program, const char *name);
 #endif